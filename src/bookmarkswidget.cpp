@@ -16,13 +16,22 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
  ***************************************************************************/
 
+#include <QApplication>
 #include <QDebug>
+#include <QFileInfo>
+#include <QPointer>
 #include <QShortcut>
 
 #include "bookmarkswidget.h"
 #include "properties.h"
 #include "config.h"
+#include "qterminalutils.h"
 
+#include <algorithm>
+
+
+// groups larger than this are populated in steps through fetchMore()
+static const int FetchBatchSize = 256;
 
 class AbstractBookmarkItem
 {
@@ -35,7 +44,9 @@ public:
 
     AbstractBookmarkItem(ItemType type, AbstractBookmarkItem* parent = nullptr)
         : m_type(type),
-          m_parent(parent)
+          m_parent(parent),
+          m_row(0),
+          m_fetched(0)
     {
     }
     virtual ~AbstractBookmarkItem()
@@ -43,27 +54,38 @@ public:
         qDeleteAll(m_children);
     }
 
-    ItemType type() { return m_type; }
-    QString value() { return m_value; }
-    QString display() { return m_display; }
-
-    void addChild(AbstractBookmarkItem* item) { m_children << item; }
-    int childCount() { return m_children.count(); }
-    QList<AbstractBookmarkItem*> children() { return m_children; }
-    AbstractBookmarkItem *child(int number) { return m_children.value(number); }
-    AbstractBookmarkItem *parent() { return m_parent; }
+    ItemType type() const { return m_type; }
+    const QString& value() const { return m_value; }
+    const QString& display() const { return m_display; }
 
-    int childNumber() const
+    void addChild(AbstractBookmarkItem* item)
     {
-        if (m_parent)
-            return m_parent->children().indexOf(const_cast<AbstractBookmarkItem*>(this));
+        item->m_row = m_children.size();
+        m_children.append(item);
+        if (m_fetched < FetchBatchSize)
+            ++m_fetched;
+    }
+    int childCount() const { return m_children.count(); }
+    const QList<AbstractBookmarkItem*>& children() const { return m_children; }
+    AbstractBookmarkItem *child(int number) const { return m_children.value(number); }
+    AbstractBookmarkItem *parent() const { return m_parent; }
+
+    int childNumber() const { return m_row; }
 
-        return 0;
+    // number of children already exposed to views
+    int fetchedCount() const { return m_fetched; }
+    int fetchMore()
+    {
+        int count = qMin(FetchBatchSize, childCount() - m_fetched);
+        m_fetched += count;
+        return count;
     }
 
 protected:
     ItemType m_type;
     AbstractBookmarkItem *m_parent;
+    int m_row;
+    int m_fetched;
     QList<AbstractBookmarkItem*> m_children;
     QString m_value;
     QString m_display;
@@ -103,12 +125,6 @@ public:
 
 class BookmarkFileGroupItem : public BookmarkGroupItem
 {
-    // hierarchy handling
-    // m_pos to group map. Example: group1.group2=item
-    QHash<QString,AbstractBookmarkItem*> m_map;
-    // current position level. Example "group1", "group2"
-    QStringList m_pos;
-
 public:
     BookmarkFileGroupItem(AbstractBookmarkItem *parent, const QString &fname)
         : BookmarkGroupItem(QObject::tr("Synchronized Bookmarks"), parent)
@@ -124,6 +140,9 @@ public:
         QXmlStreamReader xml;
         xml.setDevice(&f);
 
+        // currently open groups, innermost last
+        QList<AbstractBookmarkItem*> groups;
+
         while (true)
         {
             xml.readNext();
@@ -132,17 +151,16 @@ public:
             {
             case QXmlStreamReader::StartElement:
             {
-                AbstractBookmarkItem *parent = m_map.contains(xmlPos()) ? m_map[xmlPos()] : this;
-                QString tag = xml.name().toString();
+                AbstractBookmarkItem *parent = groups.isEmpty() ? this : groups.constLast();
+                const auto tag = xml.name();
                 if (tag == QLatin1String("group"))
                 {
                     QString name = xml.attributes().value(QLatin1String("name")).toString();
-                    m_pos.append(name);
 
                     BookmarkGroupItem *i = new BookmarkGroupItem(name, parent);
                     parent->addChild(i);
 
-                    m_map[xmlPos()] = i;
+                    groups.append(i);
                 }
                 else if (tag == QLatin1String("command"))
                 {
@@ -156,50 +174,97 @@ public:
             }
             case QXmlStreamReader::EndElement:
             {
-                QString tag = xml.name().toString();
-                if (tag == QLatin1String("group"))
+                if (xml.name() == QLatin1String("group") && !groups.isEmpty())
                 {
-                    m_pos.removeLast();
+                    groups.removeLast();
                 }
                 break;
             }
             case QXmlStreamReader::Invalid:
                 qDebug() << "XML error: " << xml.errorString().constData()
                          << xml.lineNumber() << xml.columnNumber();
-                m_map.clear();
                 return;
             case QXmlStreamReader::EndDocument:
-                m_map.clear();
                 return;
             default:
                 break;
             } // switch
         } // while
     } // constructor
-
-    QString xmlPos()
-    {
-        return m_pos.join(QLatin1Char('.'));
-    }
 };
 
 
 BookmarksModel::BookmarksModel(QObject *parent)
     : QAbstractItemModel(parent),
-      m_root(nullptr)
+      m_root(new BookmarkRootItem()),
+      m_loaded(false),
+      m_fileSize(-1)
 {
-    setup();
+}
+
+BookmarksModel *BookmarksModel::Instance()
+{
+    static QPointer<BookmarksModel> model;
+    if (!model)
+        model = new BookmarksModel(qApp);
+    return model;
 }
 
 void BookmarksModel::setup()
 {
+    const QString fname = Properties::Instance()->bookmarksFile;
+    const QFileInfo info(fname);
+    const QDateTime modified = info.exists() ? info.lastModified() : QDateTime();
+    const qint64 size = info.exists() ? info.size() : -1;
+    if (m_loaded && fname == m_fileName && modified == m_fileModified && size == m_fileSize)
+        return;
+    m_loaded = true;
+    m_fileName = fname;
+    m_fileModified = modified;
+    m_fileSize = size;
+
+    beginResetModel();
     delete m_root;
     m_root = new BookmarkRootItem();
     m_root->addChild(new BookmarkFileGroupItem(m_root, Properties::Instance()->bookmarksFile));
-    beginResetModel();
+    m_searchIndex.clear();
+    buildSearchIndex(m_root);
     endResetModel();
 }
 
+void BookmarksModel::buildSearchIndex(AbstractBookmarkItem *parent)
+{
+    for (AbstractBookmarkItem *item : parent->children())
+    {
+        if (item->type() == AbstractBookmarkItem::Command)
+        {
+            m_searchIndex.append({item, item->display().toCaseFolded(), item->value().toCaseFolded()});
+        }
+        else
+        {
+            buildSearchIndex(item);
+        }
+    }
+}
+
+QModelIndex BookmarksModel::indexForItem(AbstractBookmarkItem *item, int column) const
+{
+    if (!item || item == m_root)
+        return QModelIndex();
+    return createIndex(item->childNumber(), column, item);
+}
+
+void BookmarksModel::fetchItem(AbstractBookmarkItem *item)
+{
+    AbstractBookmarkItem *parentItem = item ? item->parent() : nullptr;
+    if (!parentItem)
+        return;
+    fetchItem(parentItem);
+    const QModelIndex parent = indexForItem(parentItem, 0);
+    while (parentItem->fetchedCount() <= item->childNumber())
+        fetchMore(parent);
+}
+
 BookmarksModel::~BookmarksModel()
 {
     delete m_root;
@@ -211,20 +276,17 @@ int BookmarksModel::columnCount(const QModelIndex & /* parent */) const
     return 2;
 }
 
-QVariant BookmarksModel::data(const QModelIndex &index, int role) const
+static QVariant bookmarkData(const AbstractBookmarkItem *item, int column, int role)
 {
-    if (!index.isValid())
-        return QVariant();
-
     switch (role)
     {
     case Qt::DisplayRole:
     case Qt::EditRole:
-        return index.column() == 0 ? getItem(index)->display() : getItem(index)->value();
+        return column == 0 ? item->display() : item->value();
     case Qt::FontRole:
     {
         QFont f;
-        if (static_cast<AbstractBookmarkItem*>(index.internalPointer())->type() == AbstractBookmarkItem::Group)
+        if (item->type() == AbstractBookmarkItem::Group)
         {
             f.setBold(true);
         }
@@ -235,6 +297,14 @@ QVariant BookmarksModel::data(const QModelIndex &index, int role) const
     }
 }
 
+QVariant BookmarksModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    return bookmarkData(getItem(index), index.column(), role);
+}
+
 AbstractBookmarkItem *BookmarksModel::getItem(const QModelIndex &index) const
 {
     if (index.isValid())
@@ -258,6 +328,8 @@ QModelIndex BookmarksModel::index(int row, int column, const QModelIndex &parent
         return QModelIndex();
 
     AbstractBookmarkItem *parentItem = getItem(parent);
+    if (row < 0 || row >= parentItem->fetchedCount())
+        return QModelIndex();
 
     AbstractBookmarkItem *childItem = parentItem->child(row);
     if (childItem)
@@ -284,22 +356,30 @@ QModelIndex BookmarksModel::parent(const QModelIndex &index) const
 int BookmarksModel::rowCount(const QModelIndex &parent) const
 {
     AbstractBookmarkItem *parentItem = getItem(parent);
-    return parentItem->childCount();
+    return parentItem->fetchedCount();
 }
 
-QModelIndexList BookmarksModel::allChildRows(const QModelIndex& parent) const
+bool BookmarksModel::hasChildren(const QModelIndex &parent) const
 {
-    QModelIndexList list;
-    for (int row = 0; row < rowCount(parent); ++row)
-    {
-        auto child = index(row, 0, parent); // we only need the row
-        list << child;
-        if (hasChildren(child))
-        {
-            list << allChildRows(child);
-        }
-    }
-    return list;
+    return getItem(parent)->childCount() > 0;
+}
+
+bool BookmarksModel::canFetchMore(const QModelIndex &parent) const
+{
+    AbstractBookmarkItem *parentItem = getItem(parent);
+    return parentItem->fetchedCount() < parentItem->childCount();
+}
+
+void BookmarksModel::fetchMore(const QModelIndex &parent)
+{
+    AbstractBookmarkItem *parentItem = getItem(parent);
+    int first = parentItem->fetchedCount();
+    int count = qMin(FetchBatchSize, parentItem->childCount() - first);
+    if (count <= 0)
+        return;
+    beginInsertRows(parent, first, first + count - 1);
+    parentItem->fetchMore();
+    endInsertRows();
 }
 
 #if 0
@@ -320,16 +400,167 @@ bool BookmarksModel::setData(const QModelIndex &index, const QVariant &value,
 #endif
 
 
+BookmarksFilterModel::BookmarksFilterModel(BookmarksModel *source, QObject *parent)
+    : QAbstractProxyModel(parent),
+      m_source(source)
+{
+    setSourceModel(source);
+    connect(source, &QAbstractItemModel::modelAboutToBeReset,
+            this, &BookmarksFilterModel::beginResetModel);
+    connect(source, &QAbstractItemModel::modelReset, this, [this] {
+        // the index was rebuilt, so previous matches cannot be narrowed down
+        QString pattern = m_pattern;
+        m_pattern.clear();
+        m_matches.clear();
+        m_rows.clear();
+        updateMatches(pattern);
+        endResetModel();
+    });
+}
+
+void BookmarksFilterModel::setFilter(const QString& pattern)
+{
+    const QString folded = pattern.toCaseFolded();
+    if (folded == m_pattern)
+        return;
+    beginResetModel();
+    updateMatches(folded);
+    endResetModel();
+}
+
+void BookmarksFilterModel::updateMatches(const QString& folded)
+{
+    const auto& entries = m_source->searchIndex();
+    QList<Match> matches;
+
+    auto test = [&](int entry) {
+        const auto& e = entries.at(entry);
+        int score = qMax(fuzzy_match(folded, e.display), fuzzy_match(folded, e.value));
+        if (score >= 0)
+            matches.append({entry, score});
+    };
+
+    // a longer pattern can only match a subset of what the shorter one did
+    if (!m_pattern.isEmpty() && folded.startsWith(m_pattern))
+    {
+        for (const Match& m : std::as_const(m_matches))
+            test(m.entry);
+    }
+    else if (!folded.isEmpty())
+    {
+        for (int i = 0; i < entries.size(); ++i)
+            test(i);
+    }
+
+    std::stable_sort(matches.begin(), matches.end(), [&entries](const Match& a, const Match& b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        return entries.at(a.entry).display.size() < entries.at(b.entry).display.size();
+    });
+
+    // Nothing is fetched in the shared source model here: this may run while its
+    // reset is still being delivered to other views.
+    m_rows.clear();
+    m_rows.reserve(matches.size());
+    for (int row = 0; row < matches.size(); ++row)
+        m_rows.insert(entries.at(matches.at(row).entry).item, row);
+
+    m_pattern = folded;
+    m_matches = std::move(matches);
+}
+
+AbstractBookmarkItem *BookmarksFilterModel::matchItem(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row() >= m_matches.size())
+        return nullptr;
+    return m_source->searchIndex().at(m_matches.at(index.row()).entry).item;
+}
+
+QModelIndex BookmarksFilterModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    AbstractBookmarkItem *item = matchItem(proxyIndex);
+    if (!item)
+        return QModelIndex();
+    // only the item asked for, e.g. an activated match, is fetched
+    m_source->fetchItem(item);
+    return m_source->indexForItem(item, proxyIndex.column());
+}
+
+QModelIndex BookmarksFilterModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid())
+        return QModelIndex();
+    const int row = m_rows.value(static_cast<const AbstractBookmarkItem*>(sourceIndex.internalPointer()), -1);
+    return row < 0 ? QModelIndex() : index(row, sourceIndex.column());
+}
+
+QModelIndex BookmarksFilterModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || row >= m_matches.size() || column < 0 || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex BookmarksFilterModel::parent(const QModelIndex & /* index */) const
+{
+    return QModelIndex();
+}
+
+int BookmarksFilterModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_matches.size();
+}
+
+int BookmarksFilterModel::columnCount(const QModelIndex & /* parent */) const
+{
+    return m_source->columnCount();
+}
+
+bool BookmarksFilterModel::hasChildren(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_matches.isEmpty();
+}
+
+bool BookmarksFilterModel::canFetchMore(const QModelIndex & /* parent */) const
+{
+    return false;
+}
+
+void BookmarksFilterModel::fetchMore(const QModelIndex & /* parent */)
+{
+}
+
+QVariant BookmarksFilterModel::data(const QModelIndex &index, int role) const
+{
+    const AbstractBookmarkItem *item = matchItem(index);
+    return item ? bookmarkData(item, index.column(), role) : QVariant();
+}
+
+QVariant BookmarksFilterModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    return m_source->headerData(section, orientation, role);
+}
+
+Qt::ItemFlags BookmarksFilterModel::flags(const QModelIndex &index) const
+{
+    return matchItem(index) ? Qt::ItemIsEnabled | Qt::ItemIsSelectable : Qt::NoItemFlags;
+}
+
+
 BookmarksWidget::BookmarksWidget(QWidget *parent)
     : QWidget(parent)
-    , m_model(new BookmarksModel(this))
+    , m_model(BookmarksModel::Instance())
+    , m_filterModel(new BookmarksFilterModel(m_model, this))
 {
     setupUi(this);
 
     treeView->setModel(m_model);
     treeView->header()->hide();
     setFocusProxy(filterEdit);
+    resetView();
 
+    connect(m_model, &QAbstractItemModel::modelReset,
+            this, &BookmarksWidget::resetView);
     connect(treeView, &QTreeView::activated,
             this, &BookmarksWidget::handleCommand);
     connect(filterEdit, &QLineEdit::textChanged,
@@ -345,17 +576,34 @@ BookmarksWidget::~BookmarksWidget() = default;
 
 void BookmarksWidget::setup()
 {
+    // the model is shared; every view is updated through its modelReset
     m_model->setup();
+}
+
+void BookmarksWidget::resetView()
+{
+    if (treeView->model() != m_model)
+        return; // the filtered list is shown
 
     treeView->setRootIndex(m_model->index(0, 0)); // do not show BookmarkFileGroupItem's top branch
-    treeView->expandAll();
+    expandTree();
     treeView->resizeColumnToContents(0);
     treeView->resizeColumnToContents(1);
 }
 
+void BookmarksWidget::expandTree()
+{
+    // expanding everything would lay out every row of a huge file
+    if (m_model->searchIndex().size() <= 4 * FetchBatchSize)
+        treeView->expandAll();
+    else
+        treeView->expandToDepth(0);
+}
+
 void BookmarksWidget::handleCommand(const QModelIndex& index)
 {
-    AbstractBookmarkItem *item = static_cast<AbstractBookmarkItem*>(index.internalPointer());
+    QModelIndex sourceIndex = treeView->model() == m_filterModel ? m_filterModel->mapToSource(index) : index;
+    AbstractBookmarkItem *item = static_cast<AbstractBookmarkItem*>(sourceIndex.internalPointer());
     if (!item || item->type() != AbstractBookmarkItem::Command)
         return;
 
@@ -365,21 +613,20 @@ void BookmarksWidget::handleCommand(const QModelIndex& index)
 void BookmarksWidget::filter(const QString& str)
 {
     treeView->clearSelection();
-    const QModelIndexList list = m_model->allChildRows(QModelIndex());
-    for (const auto& index : list)
+    m_filterModel->setFilter(str);
+
+    if (str.isEmpty())
     {
-        AbstractBookmarkItem *item = static_cast<AbstractBookmarkItem*>(index.internalPointer());
-        if (item && item->type() == AbstractBookmarkItem::Command)
+        if (treeView->model() != m_model)
         {
-            if (item->value().contains(str, Qt::CaseInsensitive)
-                || item->display().contains(str, Qt::CaseInsensitive))
-            {
-                treeView->setRowHidden(index.row(), index.parent(), false);
-            }
-            else
-            {
-                treeView->setRowHidden(index.row(), index.parent(), true);
-            }
+            treeView->setModel(m_model);
+            treeView->setRootIsDecorated(true);
+            resetView();
         }
     }
+    else if (treeView->model() != m_filterModel)
+    {
+        treeView->setModel(m_filterModel);
+        treeView->setRootIsDecorated(false);
+    }
 }
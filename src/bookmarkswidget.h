@@ -19,10 +19,15 @@
 #ifndef BOOKMARKSWIDGET_H
 #define BOOKMARKSWIDGET_H
 
+#include <QAbstractProxyModel>
+#include <QDateTime>
+#include <QHash>
+
 #include "ui_bookmarkswidget.h"
 
 class AbstractBookmarkItem;
 class BookmarksModel;
+class BookmarksFilterModel;
 
 
 class BookmarksWidget : public QWidget, Ui::BookmarksWidget
@@ -39,7 +44,11 @@ signals:
     void callCommand(const QString &cmd);
 
 private:
+    void resetView();
+    void expandTree();
+
     BookmarksModel *m_model;
+    BookmarksFilterModel *m_filterModel;
 
 private slots:
     void handleCommand(const QModelIndex& index);
@@ -55,6 +64,10 @@ public:
     BookmarksModel(QObject *parent = nullptr);
     ~BookmarksModel() override;
 
+    // the model shared by all windows of the process
+    static BookmarksModel *Instance();
+
+    // (re)loads the bookmarks file if it has changed since the last call
     void setup();
 
     QVariant data(const QModelIndex &index, int role) const override;
@@ -67,12 +80,83 @@ public:
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
 
-    QModelIndexList allChildRows(const QModelIndex& parent) const;
+    // case-folded text of every command, rebuilt by setup()
+    struct SearchEntry
+    {
+        AbstractBookmarkItem *item;
+        QString display;
+        QString value;
+    };
+    const QList<SearchEntry>& searchIndex() const { return m_searchIndex; }
+
+    QModelIndex indexForItem(AbstractBookmarkItem *item, int column) const;
+    // fetches the rows up to item and its ancestors, so that indexForItem() is valid
+    void fetchItem(AbstractBookmarkItem *item);
 
 private:
     AbstractBookmarkItem *getItem(const QModelIndex &index) const;
+    void buildSearchIndex(AbstractBookmarkItem *parent);
+
     AbstractBookmarkItem *m_root;
+    QList<SearchEntry> m_searchIndex;
+
+    bool m_loaded;
+    QString m_fileName;
+    QDateTime m_fileModified;
+    qint64 m_fileSize;
+};
+
+
+// Flat list of the commands matching a fuzzy pattern, best match first
+class BookmarksFilterModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    BookmarksFilterModel(BookmarksModel *source, QObject *parent = nullptr);
+
+    void setFilter(const QString& pattern);
+
+    // builds the rows of the source model down to the match
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
+    // served from the search index; matches are not fetched in the source model
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    QModelIndex index(int row, int column,
+                      const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    struct Match
+    {
+        int entry; // position in BookmarksModel::searchIndex()
+        int score;
+    };
+
+    void updateMatches(const QString& folded);
+    AbstractBookmarkItem *matchItem(const QModelIndex &index) const;
+
+    BookmarksModel *m_source;
+    QString m_pattern; // case-folded
+    QList<Match> m_matches;
+    // row of each matching item, for mapFromSource()
+    QHash<const AbstractBookmarkItem*, int> m_rows;
 };
 
 #endif
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+
+#include "bulkactiondialog.h"
+#include "qterminalapp.h"
+#include "terminalselector.h"
+
+BulkActionDialog::BulkActionDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Apply to Terminals"));
+
+    m_selector = new QLineEdit(this);
+    m_selector->setPlaceholderText(tr("e.g. foregroundProcess == ssh and cwd under /srv"));
+    m_selector->setToolTip(tr("Conditions joined by \"and\": key == value, key != value, "
+                              "key =~ wildcard, key under directory, idle or busy.\n"
+                              "Keys: label, title, cwd, foregroundProcess, profile, columns, lines."));
+
+    m_action = new QComboBox(this);
+    m_action->addItem(tr("Send text"), QStringLiteral("sendText"));
+    m_action->addItem(tr("Close terminal"), QStringLiteral("close"));
+    m_action->addItem(tr("Rename tab"), QStringLiteral("setLabel"));
+    m_action->addItem(tr("Close tab"), QStringLiteral("closeTab"));
+
+    m_argument = new QLineEdit(this);
+    m_status = new QLabel(this);
+
+    m_buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(m_buttons, &QDialogButtonBox::accepted, this, &BulkActionDialog::accept);
+    connect(m_buttons, &QDialogButtonBox::rejected, this, &BulkActionDialog::reject);
+
+    QFormLayout *layout = new QFormLayout(this);
+    layout->addRow(tr("&Terminals:"), m_selector);
+    layout->addRow(QString(), m_status);
+    layout->addRow(tr("&Action:"), m_action);
+    layout->addRow(tr("A&rgument:"), m_argument);
+    layout->addRow(m_buttons);
+
+    connect(m_selector, &QLineEdit::textChanged, this, &BulkActionDialog::updateMatches);
+    connect(m_action, &QComboBox::currentIndexChanged, this, [this] {
+        const QString action = m_action->currentData().toString();
+        m_argument->setEnabled(action == QLatin1String("sendText") || action == QLatin1String("setLabel"));
+    });
+    updateMatches();
+    resize(480, sizeHint().height());
+}
+
+void BulkActionDialog::updateMatches()
+{
+    QString error;
+    const TerminalSelector selector = TerminalSelector::parse(m_selector->text(), &error);
+    if (selector.isValid())
+    {
+        const int count = QTerminalApp::Instance()->matchingTerminals(selector).size();
+        m_status->setText(tr("%n terminal(s) match", nullptr, count));
+    }
+    else
+    {
+        m_status->setText(m_selector->text().trimmed().isEmpty() ? QString() : error);
+    }
+    m_buttons->button(QDialogButtonBox::Ok)->setEnabled(selector.isValid());
+}
+
+void BulkActionDialog::accept()
+{
+    QString argument = m_argument->text();
+    // a command line is run like typed at the prompt
+    if (m_action->currentData().toString() == QLatin1String("sendText") && !argument.isEmpty())
+        argument += QLatin1Char('\r');
+    QTerminalApp::Instance()->applyToTerminals(m_selector->text(), m_action->currentData().toString(), argument);
+    QDialog::accept();
+}
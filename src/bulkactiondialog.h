@@ -0,0 +1,53 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef BULKACTIONDIALOG_H
+#define BULKACTIONDIALOG_H
+
+#include <QDialog>
+
+class QComboBox;
+class QDialogButtonBox;
+class QLabel;
+class QLineEdit;
+
+/*! \brief Runs one action on all terminals matching a TerminalSelector.
+
+The number of matching terminals is shown while the selector is typed.
+See QTerminalApp::applyToTerminals().
+*/
+class BulkActionDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit BulkActionDialog(QWidget *parent = nullptr);
+
+    void accept() override;
+
+private:
+    void updateMatches();
+
+    QLineEdit *m_selector;
+    QComboBox *m_action;
+    QLineEdit *m_argument;
+    QLabel *m_status;
+    QDialogButtonBox *m_buttons;
+};
+
+#endif
@@ -0,0 +1,413 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include <QAction>
+#include <QApplication>
+#include <QHash>
+#include <QKeyEvent>
+#include <QLineEdit>
+#include <QListView>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <climits>
+
+#include "commandpalette.h"
+#include "bookmarkswidget.h"
+#include "properties.h"
+#include "qterminalapp.h"
+#include "qterminalutils.h"
+#include "tabwidget.h"
+#include "termwidget.h"
+#include "termwidgetholder.h"
+
+// more results are not useful in a popup and only cost sorting time
+static const int MaxResults = 200;
+
+CommandPaletteIndex::CommandPaletteIndex(QObject *parent)
+    : QObject(parent)
+{
+}
+
+CommandPaletteIndex *CommandPaletteIndex::Instance()
+{
+    static QPointer<CommandPaletteIndex> index;
+    if (!index)
+        index = new CommandPaletteIndex(qApp);
+    return index;
+}
+
+void CommandPaletteIndex::setEntry(QObject *target, Kind kind, QObject *owner, const QString &text, const QString &detail)
+{
+    auto it = m_entries.find(target);
+    if (it == m_entries.end())
+    {
+        it = m_entries.insert(target, Entry{kind, owner, QString(), QString(), QString()});
+        connect(target, &QObject::destroyed, this, [this](QObject *obj) {
+            m_entries.remove(obj);
+        });
+    }
+    else if (it->text == text && it->detail == detail)
+    {
+        return;
+    }
+    it->text = text;
+    it->detail = detail;
+    it->key = (detail.isEmpty() ? text : text + QLatin1Char(' ') + detail).toCaseFolded();
+}
+
+void CommandPaletteIndex::setActions(QObject *window, const QMap<QString, QAction*> &actions)
+{
+    for (QAction *action : actions)
+    {
+        QString text = action->text();
+        Properties::removeAccelerator(text);
+        setEntry(action, Action, window, text, action->shortcut().toString(QKeySequence::NativeText));
+    }
+}
+
+void CommandPaletteIndex::addTabWidget(TabWidget *tabs)
+{
+    for (int i = 0; i < tabs->count(); ++i)
+    {
+        if (auto holder = qobject_cast<TermWidgetHolder*>(tabs->widget(i)))
+            addTab(holder);
+    }
+    connect(tabs, &TabWidget::tabAdded, this, &CommandPaletteIndex::addTab);
+    connect(tabs, &TabWidget::tabRenamed, this, [this](TermWidgetHolder *holder, const QString &text) {
+        auto it = m_entries.constFind(holder);
+        setEntry(holder, Tab, nullptr, text, it == m_entries.cend() ? QString() : it->detail);
+    });
+}
+
+void CommandPaletteIndex::addTab(TermWidgetHolder *holder)
+{
+    auto tabs = findParent<TabWidget>(holder);
+    const int index = tabs ? tabs->indexOf(holder) : -1;
+    setEntry(holder, Tab, nullptr, index >= 0 ? tabs->tabText(index) : holder->windowTitle(), QString());
+
+    const auto terms = holder->findChildren<TermWidget*>();
+    for (TermWidget *term : terms)
+        addPane(term);
+    connect(holder, &TermWidgetHolder::terminalAdded, this, &CommandPaletteIndex::addPane);
+}
+
+void CommandPaletteIndex::addPane(TermWidget *term)
+{
+    updatePane(term);
+    // the working directory is a good hint, and it usually changes with the title
+    connect(term, &TermWidget::termTitleChanged, this, [this, term] {
+        updatePane(term);
+    });
+}
+
+void CommandPaletteIndex::updatePane(TermWidget *term)
+{
+    QString title = term->impl()->title();
+    if (title.isEmpty())
+    {
+        if (auto holder = findParent<TermWidgetHolder>(term))
+            title = holder->windowTitle();
+    }
+    const QString cwd = term->impl()->workingDirectory();
+    setEntry(term, Pane, nullptr, title, cwd);
+
+    // a tab is also found by the directory of its current terminal
+    auto holder = findParent<TermWidgetHolder>(term);
+    if (holder && holder->currentTerminal() == term)
+    {
+        auto it = m_entries.constFind(holder);
+        if (it != m_entries.cend())
+            setEntry(holder, Tab, nullptr, it->text, cwd);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+CommandPaletteModel::CommandPaletteModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void CommandPaletteModel::setFilter(QObject *window, const QString &pattern)
+{
+    const QString folded = pattern.toCaseFolded();
+
+    struct Candidate
+    {
+        const CommandPaletteIndex::Entry *entry;
+        QObject *target;
+        int bookmark;
+        int score;
+        // window and tab index of a tab, ties in score are listed in this order
+        int window;
+        int tab;
+    };
+    QList<Candidate> candidates;
+
+    // window and tab index of every tab, looked up once per call
+    QHash<QObject*, QPair<int, int>> positions;
+    const QList<MainWindow*> windows = QTerminalApp::Instance()->getWindowList();
+    for (int w = 0; w < windows.size(); ++w)
+    {
+        if (TabWidget *tabs = windows.at(w)->findChild<TabWidget*>())
+        {
+            for (int t = 0; t < tabs->count(); ++t)
+                positions.insert(tabs->widget(t), qMakePair(w, t));
+        }
+    }
+
+    const auto &entries = CommandPaletteIndex::Instance()->entries();
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+    {
+        const auto &entry = it.value();
+        if (entry.kind == CommandPaletteIndex::Action)
+        {
+            auto action = static_cast<QAction*>(it.key());
+            if (entry.owner != window || !action->isEnabled() || !action->isVisible())
+                continue;
+        }
+        else if (folded.isEmpty() && entry.kind != CommandPaletteIndex::Tab)
+        {
+            continue; // list the tabs until something is typed
+        }
+        const int score = fuzzy_match(folded, entry.key);
+        if (score < 0)
+            continue;
+        int windowIndex = INT_MAX;
+        int tabIndex = INT_MAX;
+        if (entry.kind == CommandPaletteIndex::Tab)
+        {
+            const auto position = positions.constFind(it.key());
+            if (position != positions.cend())
+            {
+                windowIndex = position->first;
+                tabIndex = position->second;
+            }
+        }
+        candidates.append({&entry, it.key(), -1, score, windowIndex, tabIndex});
+    }
+
+    BookmarksModel *bookmarks = nullptr;
+    if (Properties::Instance()->useBookmarks && !folded.isEmpty())
+    {
+        bookmarks = BookmarksModel::Instance();
+        bookmarks->setup();
+        const auto &index = bookmarks->searchIndex();
+        for (int i = 0; i < index.size(); ++i)
+        {
+            const int score = qMax(fuzzy_match(folded, index.at(i).display), fuzzy_match(folded, index.at(i).value));
+            if (score >= 0)
+                candidates.append({nullptr, nullptr, i, score, INT_MAX, INT_MAX});
+        }
+    }
+
+    auto middle = candidates.begin() + qMin(MaxResults, int(candidates.size()));
+    // the index is a hash, so everything but the score needs a fixed order
+    std::partial_sort(candidates.begin(), middle, candidates.end(), [](const Candidate &a, const Candidate &b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        if (a.window != b.window)
+            return a.window < b.window;
+        if (a.tab != b.tab)
+            return a.tab < b.tab;
+        if (a.entry && b.entry)
+            return a.entry->text < b.entry->text;
+        return a.bookmark < b.bookmark;
+    });
+
+    beginResetModel();
+    m_results.clear();
+    for (auto it = candidates.begin(); it != middle; ++it)
+    {
+        if (it->entry)
+        {
+            m_results.append({it->entry->kind, it->target, it->entry->text, it->entry->detail, it->score});
+        }
+        else
+        {
+            auto item = bookmarks->searchIndex().at(it->bookmark).item;
+            m_results.append({CommandPaletteIndex::Bookmark, nullptr,
+                              bookmarks->data(bookmarks->indexForItem(item, 0), Qt::DisplayRole).toString(),
+                              bookmarks->data(bookmarks->indexForItem(item, 1), Qt::DisplayRole).toString(),
+                              it->score});
+        }
+    }
+    endResetModel();
+}
+
+const CommandPaletteModel::Result *CommandPaletteModel::result(int row) const
+{
+    if (row < 0 || row >= m_results.size())
+        return nullptr;
+    return &m_results.at(row);
+}
+
+int CommandPaletteModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_results.size();
+}
+
+QVariant CommandPaletteModel::data(const QModelIndex &index, int role) const
+{
+    const Result *r = result(index.row());
+    if (!r)
+        return QVariant();
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return r->detail.isEmpty() ? r->text : r->text + QLatin1String("    ") + r->detail;
+    case Qt::ToolTipRole:
+        return r->detail;
+    case Qt::DecorationRole:
+        switch (r->kind)
+        {
+        case CommandPaletteIndex::Action:
+            if (auto action = qobject_cast<QAction*>(r->target))
+                return action->icon();
+            return QVariant();
+        case CommandPaletteIndex::Bookmark:
+            return QIcon::fromTheme(QStringLiteral("bookmarks"));
+        case CommandPaletteIndex::Tab:
+            return QIcon::fromTheme(QStringLiteral("tab-new"));
+        case CommandPaletteIndex::Pane:
+            return QIcon::fromTheme(QStringLiteral("utilities-terminal"));
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+CommandPalette::CommandPalette(QWidget *window)
+    : QFrame(window, Qt::Popup),
+      m_edit(new QLineEdit(this)),
+      m_list(new QListView(this)),
+      m_model(new CommandPaletteModel(this))
+{
+    setFrameStyle(QFrame::StyledPanel | QFrame::Raised);
+
+    QVBoxLayout *lay = new QVBoxLayout(this);
+    lay->setContentsMargins(2, 2, 2, 2);
+    lay->setSpacing(2);
+    lay->addWidget(m_edit);
+    lay->addWidget(m_list);
+
+    m_edit->setPlaceholderText(tr("Search actions, bookmarks, tabs and panes"));
+    m_edit->installEventFilter(this);
+
+    m_list->setModel(m_model);
+    m_list->setUniformItemSizes(true);
+    m_list->setFocusPolicy(Qt::NoFocus);
+    m_list->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+    connect(m_edit, &QLineEdit::textChanged, this, [this](const QString &text) {
+        m_model->setFilter(parentWidget(), text);
+        m_list->setCurrentIndex(m_model->index(0));
+    });
+    connect(m_list, &QListView::activated, this, &CommandPalette::activate);
+}
+
+void CommandPalette::popup()
+{
+    QWidget *win = parentWidget();
+    m_edit->blockSignals(true);
+    m_edit->clear();
+    m_edit->blockSignals(false);
+    m_model->setFilter(win, QString());
+    m_list->setCurrentIndex(m_model->index(0));
+
+    const int w = qBound(qMin(400, win->width()), win->width() * 3 / 5, win->width());
+    const int h = qMax(win->height() / 2, m_edit->sizeHint().height() * 4);
+    resize(w, h);
+    const QPoint topCenter = win->mapToGlobal(QPoint(win->width() / 2, 0));
+    move(topCenter.x() - w / 2, topCenter.y());
+
+    show();
+    m_edit->setFocus();
+}
+
+bool CommandPalette::eventFilter(QObject *obj, QEvent *event)
+{
+    if (obj == m_edit && event->type() == QEvent::KeyPress)
+    {
+        QKeyEvent *ke = static_cast<QKeyEvent*>(event);
+        switch (ke->key())
+        {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QApplication::sendEvent(m_list, event);
+            return true;
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+            activate(m_list->currentIndex());
+            return true;
+        case Qt::Key_Escape:
+            hide();
+            return true;
+        default:
+            break;
+        }
+    }
+    return QFrame::eventFilter(obj, event);
+}
+
+void CommandPalette::activate(const QModelIndex &index)
+{
+    const CommandPaletteModel::Result *r = m_model->result(index.row());
+    if (!r)
+        return;
+    const CommandPaletteModel::Result res = *r;
+    hide();
+
+    switch (res.kind)
+    {
+    case CommandPaletteIndex::Action:
+        if (auto action = qobject_cast<QAction*>(res.target))
+            action->trigger();
+        break;
+    case CommandPaletteIndex::Bookmark:
+        emit callCommand(res.detail + QLatin1Char('\n'));
+        break;
+    case CommandPaletteIndex::Tab:
+    case CommandPaletteIndex::Pane:
+    {
+        if (!res.target)
+            break;
+        TermWidget *term = qobject_cast<TermWidget*>(res.target);
+        TermWidgetHolder *holder = term ? findParent<TermWidgetHolder>(term) : qobject_cast<TermWidgetHolder*>(res.target);
+        TabWidget *tabs = holder ? findParent<TabWidget>(holder) : nullptr;
+        if (!tabs)
+            break;
+        tabs->setCurrentIndex(tabs->indexOf(holder));
+        QWidget *win = tabs->window();
+        win->show();
+        win->raise();
+        win->activateWindow();
+        if (!term)
+            term = holder->currentTerminal();
+        if (term && term->focusProxy() != nullptr)
+            term->setFocus(Qt::OtherFocusReason);
+        break;
+    }
+    }
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef COMMANDPALETTE_H
+#define COMMANDPALETTE_H
+
+#include <QAbstractListModel>
+#include <QFrame>
+#include <QHash>
+#include <QPointer>
+
+class QAction;
+class QLineEdit;
+class QListView;
+class TabWidget;
+class TermWidget;
+class TermWidgetHolder;
+
+/*! \brief Process-wide search index of the command palette.
+
+Actions, tabs and panes of all windows are kept here and updated from
+the signals of their owners, so opening the palette never walks the
+windows. Bookmarks are searched through the index of BookmarksModel.
+*/
+class CommandPaletteIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind {
+        Action,
+        Bookmark,
+        Tab,
+        Pane
+    };
+
+    struct Entry
+    {
+        Kind kind;
+        QObject *owner; // the window of an action
+        QString text;
+        QString detail;
+        QString key; // case-folded text and detail
+    };
+
+    static CommandPaletteIndex *Instance();
+
+    void setActions(QObject *window, const QMap<QString, QAction*> &actions);
+    void addTabWidget(TabWidget *tabs);
+
+    // keyed by the QAction, TermWidgetHolder or TermWidget
+    const QHash<QObject*, Entry>& entries() const { return m_entries; }
+
+private:
+    CommandPaletteIndex(QObject *parent);
+
+    void addTab(TermWidgetHolder *holder);
+    void addPane(TermWidget *term);
+    void updatePane(TermWidget *term);
+    void setEntry(QObject *target, Kind kind, QObject *owner, const QString &text, const QString &detail);
+
+    QHash<QObject*, Entry> m_entries;
+};
+
+
+class CommandPaletteModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    struct Result
+    {
+        CommandPaletteIndex::Kind kind;
+        QPointer<QObject> target; // null for bookmarks
+        QString text;
+        QString detail;
+        int score;
+    };
+
+    CommandPaletteModel(QObject *parent = nullptr);
+
+    void setFilter(QObject *window, const QString &pattern);
+    const Result *result(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    QList<Result> m_results;
+};
+
+
+class CommandPalette : public QFrame
+{
+    Q_OBJECT
+
+public:
+    CommandPalette(QWidget *window);
+
+    void popup();
+
+signals:
+    void callCommand(const QString &cmd);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    void activate(const QModelIndex &index);
+
+    QLineEdit *m_edit;
+    QListView *m_list;
+    CommandPaletteModel *m_model;
+};
+
+#endif
@@ -67,6 +67,9 @@
 
 #define HANDLE_HISTORY "Handle history"
 
+#define COMMAND_PALETTE "Command Palette"
+#define APPLY_TO_TERMINALS "Apply to Terminals"
+
 /* Some defaults for QTerminal application */
 
 #define DEFAULT_WIDTH                  800
@@ -124,6 +127,8 @@
 
 #define FULLSCREEN_SHORTCUT           "F11"
 
+#define COMMAND_PALETTE_SHORTCUT      "Ctrl+Shift+P"
+
 // XON/XOFF features:
 
 #define FLOW_CONTROL_ENABLED		false
@@ -0,0 +1,262 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include "controlserver.h"
+#include "qterminalapp.h"
+#include "terminalselector.h"
+#include "termwidgetholder.h"
+#include "termwidget.h"
+
+namespace {
+
+const qint64 MaxRequestSize = 16 * 1024 * 1024;
+
+QHash<QString,QVariant> termArgs(const QJsonObject &args)
+{
+    QHash<QString,QVariant> hash = args.toVariantHash();
+    // JSON arrays arrive as variant lists, TerminalConfig wants string lists
+    for (auto it = hash.begin(); it != hash.end(); ++it)
+    {
+        if (it.value().typeId() == QMetaType::QVariantList)
+            it.value() = it.value().toStringList();
+    }
+    return hash;
+}
+
+} // namespace
+
+ControlServer::ControlServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this))
+{
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::newConnection);
+}
+
+ControlServer::~ControlServer()
+{
+    m_server->close();
+}
+
+bool ControlServer::listen(const QString &path)
+{
+    // a stale socket of a crashed instance with the same pid
+    QLocalServer::removeServer(path);
+    if (!m_server->listen(path))
+    {
+        qWarning() << "Cannot listen on" << path << ":" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+QString ControlServer::path() const
+{
+    return m_server->isListening() ? m_server->fullServerName() : QString();
+}
+
+void ControlServer::newConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection())
+    {
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket] { readRequests(socket); });
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void ControlServer::readRequests(QLocalSocket *socket)
+{
+    // everything that is complete is answered at once, so requests can be pipelined
+    while (socket->canReadLine())
+    {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+        QJsonObject reply;
+        if (!doc.isObject())
+        {
+            reply[QLatin1String("error")] = error.error != QJsonParseError::NoError
+                ? error.errorString() : QStringLiteral("request is not an object");
+        }
+        else
+        {
+            reply = handle(doc.object());
+        }
+        socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact));
+        socket->write("\n");
+    }
+    if (socket->bytesAvailable() > MaxRequestSize)
+        socket->disconnectFromServer();
+}
+
+QJsonObject ControlServer::handle(const QJsonObject &request)
+{
+    const QString method = request.value(QLatin1String("method")).toString();
+    const QString target = request.value(QLatin1String("target")).toString();
+    const QJsonObject args = request.value(QLatin1String("args")).toObject();
+
+    QJsonObject reply;
+    if (request.contains(QLatin1String("id")))
+        reply[QLatin1String("id")] = request.value(QLatin1String("id"));
+    auto fail = [&reply](const QString &message) {
+        reply[QLatin1String("error")] = message;
+        return reply;
+    };
+
+    QTerminalApp *app = QTerminalApp::Instance();
+    QJsonValue result;
+
+    if (method == QLatin1String("getLayout"))
+    {
+        result = QJsonObject::fromVariantMap(app->getLayout());
+    }
+    else if (method == QLatin1String("newWindow"))
+    {
+        TerminalConfig cfg = TerminalConfig::fromDbus(termArgs(args));
+        result = app->newWindow(false, cfg)->getDbusPathString();
+    }
+    else if (method == QLatin1String("newTab"))
+    {
+        MainWindow *wnd = target.isEmpty() ? qobject_cast<MainWindow*>(app->activeWindow()) : findWindow(target);
+        if (wnd == nullptr && target.isEmpty() && !app->getWindowList().isEmpty())
+            wnd = app->getWindowList().constFirst();
+        if (wnd == nullptr)
+            return fail(QStringLiteral("no such window"));
+        TerminalConfig cfg = TerminalConfig::fromDbus(termArgs(args));
+        TermWidgetHolder *tab = wnd->addTab(cfg);
+        QJsonObject paths;
+        paths[QLatin1String("tab")] = tab->getDbusPathString();
+        // a tab in the background is only built by getActiveTerminal
+        if (tab->isMaterialized())
+            paths[QLatin1String("terminal")] = tab->currentTerminal()->getDbusPathString();
+        result = paths;
+    }
+    else if (method == QLatin1String("getActiveTerminal"))
+    {
+        TermWidgetHolder *tab = findTab(target);
+        if (tab == nullptr)
+            return fail(QStringLiteral("no such tab"));
+        result = tab->currentTerminal()->getDbusPathString();
+    }
+    else if (method == QLatin1String("splitHorizontal") || method == QLatin1String("splitVertical"))
+    {
+        TermWidget *term = findTerminal(target);
+        if (term == nullptr)
+            return fail(QStringLiteral("no such terminal"));
+        TermWidgetHolder *holder = findParent<TermWidgetHolder>(term);
+        const Qt::Orientation orientation = method == QLatin1String("splitHorizontal") ? Qt::Horizontal : Qt::Vertical;
+        const int percent = qBound(1, args.value(QLatin1String("newPercent")).toInt(50), 99);
+        result = holder->split(term, orientation, TerminalConfig::fromDbus(termArgs(args), term), QString(), percent)->getDbusPathString();
+    }
+    else if (method == QLatin1String("sendText"))
+    {
+        TermWidget *term = findTerminal(target);
+        if (term == nullptr)
+            return fail(QStringLiteral("no such terminal"));
+        term->impl()->sendText(args.value(QLatin1String("text")).toString());
+    }
+    else if (method == QLatin1String("closeTerminal"))
+    {
+        TermWidget *term = findTerminal(target);
+        if (term == nullptr)
+            return fail(QStringLiteral("no such terminal"));
+        findParent<TermWidgetHolder>(term)->splitCollapse(term);
+    }
+    else if (method == QLatin1String("setLabel"))
+    {
+        TermWidgetHolder *tab = findTab(target);
+        if (tab == nullptr)
+            return fail(QStringLiteral("no such tab"));
+        tab->setLabel(args.value(QLatin1String("label")).toString());
+    }
+    else if (method == QLatin1String("closeTab"))
+    {
+        TermWidgetHolder *tab = findTab(target);
+        if (tab == nullptr)
+            return fail(QStringLiteral("no such tab"));
+        tab->closeTab();
+    }
+    else if (method == QLatin1String("applyToTerminals"))
+    {
+        const QString selector = args.value(QLatin1String("selector")).toString();
+        const QString action = args.value(QLatin1String("action")).toString();
+        QString error;
+        if (!TerminalSelector::parse(selector, &error).isValid())
+            return fail(QStringLiteral("invalid selector: %1").arg(error));
+        const int count = app->applyToTerminals(selector, action, args.value(QLatin1String("argument")).toString());
+        if (count < 0)
+            return fail(QStringLiteral("unknown action \"%1\"").arg(action));
+        result = count;
+    }
+    else
+    {
+        return fail(QStringLiteral("unknown method \"%1\"").arg(method));
+    }
+
+    reply[QLatin1String("result")] = result;
+    return reply;
+}
+
+MainWindow *ControlServer::findWindow(const QString &path) const
+{
+    const auto windows = QTerminalApp::Instance()->getWindowList();
+    for (MainWindow *wnd : windows)
+    {
+        if (wnd->getDbusPathString() == path)
+            return wnd;
+    }
+    return nullptr;
+}
+
+TermWidgetHolder *ControlServer::findTab(const QString &path) const
+{
+    const auto windows = QTerminalApp::Instance()->getWindowList();
+    for (MainWindow *wnd : windows)
+    {
+        const auto tabs = wnd->findChildren<TermWidgetHolder*>();
+        for (TermWidgetHolder *tab : tabs)
+        {
+            if (tab->getDbusPathString() == path)
+                return tab;
+        }
+    }
+    return nullptr;
+}
+
+TermWidget *ControlServer::findTerminal(const QString &path) const
+{
+    const auto windows = QTerminalApp::Instance()->getWindowList();
+    for (MainWindow *wnd : windows)
+    {
+        const auto terminals = wnd->findChildren<TermWidget*>();
+        for (TermWidget *term : terminals)
+        {
+            if (term->getDbusPathString() == path)
+                return term;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,68 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QJsonObject>
+#include <QObject>
+
+class QLocalServer;
+class QLocalSocket;
+class MainWindow;
+class TermWidget;
+class TermWidgetHolder;
+
+/*! \brief Remote control over a local socket.
+
+A line based JSON protocol offering the operations of the D-Bus interfaces
+for sessions without a bus. Each request is one line:
+
+    {"id": 1, "method": "sendText", "target": "/terminals/...", "args": {"text": "ls\n"}}
+
+and is answered in order by one line holding the same id and either "result"
+or "error". Requests may be pipelined without waiting for the replies.
+
+newTab does not start the shell of a tab opened in the background, so its
+result only holds "terminal" when the tab is already built; getActiveTerminal
+on the tab builds it.
+*/
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ControlServer(QObject *parent = nullptr);
+    ~ControlServer() override;
+
+    bool listen(const QString &path);
+    QString path() const;
+
+private:
+    void newConnection();
+    void readRequests(QLocalSocket *socket);
+    QJsonObject handle(const QJsonObject &request);
+
+    MainWindow *findWindow(const QString &path) const;
+    TermWidgetHolder *findTab(const QString &path) const;
+    TermWidget *findTerminal(const QString &path) const;
+
+    QLocalServer *m_server;
+};
+
+#endif
@@ -4,14 +4,14 @@
 
 using namespace Qt::Literals::StringLiterals;
 
-#ifdef HAVE_QDBUS
-Q_DECLARE_METATYPE(QList<QDBusObjectPath>)
-
 QString DBusAddressable::getDbusPathString()
 {
     return m_path;
 }
 
+#ifdef HAVE_QDBUS
+Q_DECLARE_METATYPE(QList<QDBusObjectPath>)
+
 QDBusObjectPath DBusAddressable::getDbusPath()
 {
     return QDBusObjectPath(m_path);
@@ -20,7 +20,6 @@ QDBusObjectPath DBusAddressable::getDbusPath()
 
 DBusAddressable::DBusAddressable(const QString& prefix, const QString& name)
 {
-    #ifdef HAVE_QDBUS
     QString suffix = name;
     if (suffix.isEmpty())
     {
@@ -29,5 +28,4 @@ DBusAddressable::DBusAddressable(const QString& prefix, const QString& name)
         suffix = uuidString.replace(regExp, QString());
     }
     m_path = prefix + QLatin1Char('/') + suffix;
-    #endif
 }
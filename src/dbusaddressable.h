@@ -2,22 +2,21 @@
 #define DBUSADDRESSABLE_H
 
 #include <QString>
+#include <QUuid>
 #ifdef HAVE_QDBUS
 #include <QtDBus/QtDBus>
-#include <QUuid>
 #endif
 
+// The object paths are also used by the control socket, so they exist without D-Bus too
 class DBusAddressable
 {
-    #ifdef HAVE_QDBUS
     private:
         QString m_path;
-    #endif
     public:
     #ifdef HAVE_QDBUS
         QDBusObjectPath getDbusPath();
-        QString getDbusPathString();
     #endif
+        QString getDbusPathString();
         DBusAddressable(const QString& prefix, const QString &name = QString());
 };
 
@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
+
+#include "historyarchive.h"
+
+HistoryArchive::HistoryArchive()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QDir().mkpath(dir);
+    m_file.setFileTemplate(dir + QLatin1String("/qterminal.hibernated.XXXXXX"));
+    m_valid = m_file.open();
+    if (!m_valid)
+        qWarning() << "Failed to create" << m_file.fileTemplate() << "for hibernation";
+    m_writer.setMaxThreadCount(1);
+}
+
+HistoryArchive::~HistoryArchive()
+{
+    m_writer.waitForDone();
+}
+
+void HistoryArchive::append(QByteArray text, qsizetype maxLines)
+{
+    if (text.isEmpty() || !m_valid)
+        return;
+    if (!text.endsWith('\n'))
+        text += '\n';
+    const qsizetype lines = text.count('\n');
+    m_lines += lines;
+    m_chunkLines.append(lines);
+    const int chunk = m_chunks++;
+
+    // the file follows the same steps in write()
+    int drop = 0;
+    while (maxLines >= 0 && m_chunkLines.size() > 1 && m_lines - m_chunkLines.constFirst() >= maxLines)
+    {
+        m_lines -= m_chunkLines.takeFirst();
+        ++drop;
+    }
+
+    m_writer.start([this, chunk, lines, text, drop] {
+        write(chunk, lines, qCompress(text), drop);
+    });
+}
+
+void HistoryArchive::write(int chunk, qsizetype lines, const QByteArray &compressed, int drop)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_failed)
+    {
+        QByteArray kept;
+        if (drop > 0)
+        {
+            // the remaining chunks are copied as they are, without decompressing them
+            m_failed = !m_file.seek(0);
+            QDataStream in(&m_file);
+            QDataStream out(&kept, QIODevice::WriteOnly);
+            for (int i = 0; !m_failed && !in.atEnd(); ++i)
+            {
+                qint32 number;
+                qint64 count;
+                QByteArray data;
+                in >> number >> count >> data;
+                m_failed = in.status() != QDataStream::Ok;
+                if (!m_failed && i >= drop)
+                    out << number << count << data;
+            }
+            m_failed = m_failed || !m_file.resize(0);
+        }
+        if (!m_failed)
+        {
+            QDataStream out(&m_file);
+            m_failed = !m_file.seek(m_file.size()) || m_file.write(kept) != kept.size();
+            if (!m_failed)
+            {
+                out << qint32(chunk) << qint64(lines) << compressed;
+                m_failed = out.status() != QDataStream::Ok || !m_file.flush();
+            }
+        }
+        if (m_failed)
+            qWarning() << "Failed to write to" << m_file.fileName();
+    }
+    ++m_writtenChunks;
+    m_chunkWritten.wakeAll();
+}
+
+QByteArray HistoryArchive::read(int chunks, qsizetype *lines)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_writtenChunks < chunks)
+        m_chunkWritten.wait(&m_mutex);
+
+    QByteArray text;
+    qsizetype total = 0;
+    if (m_valid && m_file.seek(0))
+    {
+        QDataStream in(&m_file);
+        while (!in.atEnd())
+        {
+            qint32 number;
+            qint64 count;
+            QByteArray chunk;
+            in >> number >> count >> chunk;
+            if (in.status() != QDataStream::Ok || number >= chunks)
+                break;
+            text += qUncompress(chunk);
+            total += count;
+        }
+    }
+    if (lines)
+        *lines = total;
+    return text;
+}
@@ -0,0 +1,78 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef HISTORYARCHIVE_H
+#define HISTORYARCHIVE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QTemporaryFile>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+/*! \brief Scrollback moved out of a terminal, compressed in a temporary file.
+
+Chunks of lines are appended from the GUI thread; they are compressed and
+written by a worker thread in the order they were appended. read() may be
+called from any thread and waits for the chunks it asks for, so an archive
+is shared between its terminal and exports of the history.
+
+With a line limit, the oldest chunks are dropped, from memory and from the
+file, as long as the remaining ones still hold that many lines.
+*/
+class HistoryArchive
+{
+    public:
+        HistoryArchive();
+        ~HistoryArchive();
+
+        // false if the file could not be created
+        bool isValid() const { return m_valid; }
+
+        // text is '\n' terminated lines; maxLines < 0 keeps everything
+        void append(QByteArray text, qsizetype maxLines = -1);
+        // what has been appended so far, and the lines that are still kept
+        int chunkCount() const { return m_chunks; }
+        qsizetype lineCount() const { return m_lines; }
+
+        // the kept text of the first chunks chunks, with its number of lines in lines
+        QByteArray read(int chunks, qsizetype *lines = nullptr);
+
+    private:
+        HistoryArchive(const HistoryArchive &) = delete;
+        HistoryArchive &operator=(const HistoryArchive &) = delete;
+
+        void write(int chunk, qsizetype lines, const QByteArray &compressed, int drop);
+
+        QTemporaryFile m_file;
+        bool m_valid;
+        int m_chunks = 0;
+        qsizetype m_lines = 0;
+        // the lines of each kept chunk, oldest first
+        QList<qsizetype> m_chunkLines;
+
+        QMutex m_mutex;
+        QWaitCondition m_chunkWritten;
+        int m_writtenChunks = 0;
+        bool m_failed = false;
+        // a single thread keeps the chunks in order
+        QThreadPool m_writer;
+};
+
+#endif
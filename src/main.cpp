@@ -17,6 +17,7 @@
  ***************************************************************************/
 
 #include <QApplication>
+#include <QPointer>
 #include <QtGlobal>
 
 #include <cassert>
@@ -32,11 +33,17 @@
 #endif
 
 
+#ifdef HAVE_CONTROL_SOCKET
+    #include "controlserver.h"
+#endif
 #include "mainwindow.h"
 #include "qterminalapp.h"
 #include "qterminalutils.h"
+#include "tabwidget.h"
 #include "terminalconfig.h"
+#include "terminalselector.h"
 #include "termwidget.h"
+#include "termwidgetholder.h"
 
 #define out
 
@@ -190,6 +197,9 @@ int main(int argc, char *argv[])
     Properties::Instance()->migrate_settings();
     Properties::Instance()->loadSettings();
 
+    if (Properties::Instance()->controlSocket)
+        app->startControlServer();
+
     if (workdir.isEmpty())
         workdir = QDir::currentPath();
     app->setWorkingDirectory(workdir);
@@ -258,6 +268,10 @@ MainWindow *QTerminalApp::newWindow(bool dropMode, TerminalConfig &cfg, const QS
     MainWindow *window = nullptr;
     if (dropMode)
     {
+        // only one drop-down window per process
+        if (MainWindow *dropdown = dropdownWindow())
+            return dropdown;
+        m_hostsDropdown = true;
         window = new MainWindow(cfg, dropMode);
         if (Properties::Instance()->dropShowOnStart)
             window->show();
@@ -325,6 +339,176 @@ QList<MainWindow *> QTerminalApp::getWindowList()
     return m_windowList;
 }
 
+MainWindow *QTerminalApp::dropdownWindow() const
+{
+    for (MainWindow *wnd : m_windowList)
+        if (wnd->dropMode())
+            return wnd;
+    return nullptr;
+}
+
+void QTerminalApp::startControlServer()
+{
+#ifdef HAVE_CONTROL_SOCKET
+    if (m_controlServer != nullptr)
+        return;
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty())
+        return;
+    m_controlServer = new ControlServer(this);
+    if (!m_controlServer->listen(dir + QStringLiteral("/qterminal-%1.socket").arg(getpid())))
+    {
+        delete m_controlServer;
+        m_controlServer = nullptr;
+    }
+#endif
+}
+
+QString QTerminalApp::controlSocketPath() const
+{
+#ifdef HAVE_CONTROL_SOCKET
+    return m_controlServer != nullptr ? m_controlServer->path() : QString();
+#else
+    return QString();
+#endif
+}
+
+QVariantMap QTerminalApp::getLayout()
+{
+    QVariantList windows;
+    for (MainWindow *wnd : std::as_const(m_windowList))
+        windows << wnd->layoutInfo();
+
+    QVariantMap layout;
+    layout[QStringLiteral("windows")] = windows;
+    QWidget *aw = activeWindow();
+    if (MainWindow *wnd = qobject_cast<MainWindow*>(aw))
+        layout[QStringLiteral("activeWindow")] = wnd->getDbusPathString();
+    return layout;
+}
+
+QList<TermWidget*> QTerminalApp::matchingTerminals(const TerminalSelector &selector)
+{
+    QList<TermWidget*> terminals;
+    for (MainWindow *wnd : std::as_const(m_windowList))
+    {
+        // tabs that were never shown have no terminal yet and match nothing
+        const QList<TermWidget*> all = wnd->findChildren<TermWidget*>();
+        for (TermWidget *term : all)
+        {
+            QVariantMap info = term->layoutInfo();
+            TermWidgetHolder *holder = findParent<TermWidgetHolder>(term);
+            if (TabWidget *tabs = findParent<TabWidget>(holder))
+                info[QStringLiteral("label")] = tabs->tabText(tabs->indexOf(holder));
+            if (selector.matches(info))
+                terminals << term;
+        }
+    }
+    return terminals;
+}
+
+int QTerminalApp::applyToTerminals(const QString &selector, const QString &action, const QString &argument)
+{
+    static const QStringList actions{QStringLiteral("sendText"), QStringLiteral("close"),
+                                     QStringLiteral("setLabel"), QStringLiteral("closeTab")};
+    if (!actions.contains(action))
+        return -1;
+    const TerminalSelector parsed = TerminalSelector::parse(selector);
+    if (!parsed.isValid())
+        return -1;
+
+    // match everything before changing anything, closing reorders tabs and terminals
+    QList<QPointer<TermWidget>> terminals;
+    QList<QPointer<TermWidgetHolder>> holders;
+    QList<QPointer<MainWindow>> windows;
+    const QList<TermWidget*> matching = matchingTerminals(parsed);
+    for (TermWidget *term : matching)
+    {
+        terminals << term;
+        TermWidgetHolder *holder = findParent<TermWidgetHolder>(term);
+        if (!holders.contains(holder))
+            holders << holder;
+        MainWindow *wnd = findParent<MainWindow>(term);
+        if (!windows.contains(wnd))
+            windows << wnd;
+    }
+
+    // one repaint per window for the whole batch
+    for (const QPointer<MainWindow> &wnd : std::as_const(windows))
+        wnd->setUpdatesEnabled(false);
+
+    int count = action == QLatin1String("setLabel") ? holders.size() : terminals.size();
+
+    if (action == QLatin1String("sendText"))
+    {
+        for (const QPointer<TermWidget> &term : std::as_const(terminals))
+            term->impl()->sendText(argument);
+    }
+    else if (action == QLatin1String("setLabel"))
+    {
+        for (const QPointer<TermWidgetHolder> &holder : std::as_const(holders))
+            holder->setLabel(argument);
+    }
+    else
+    {
+        // Tabs whose terminals all match are removed as a whole, together with
+        // the other tabs of their window, or with the window if none is left.
+        // closeTab leaves a tab alone when any of its terminals does not match.
+        QList<TermWidgetHolder*> closingTabs;
+        for (const QPointer<TermWidgetHolder> &holder : std::as_const(holders))
+        {
+            bool whole = true;
+            const QList<TermWidget*> all = holder->findChildren<TermWidget*>();
+            for (TermWidget *term : all)
+            {
+                if (!matching.contains(term))
+                {
+                    whole = false;
+                    break;
+                }
+            }
+            if (whole)
+            {
+                closingTabs << holder;
+                continue;
+            }
+            if (action == QLatin1String("closeTab"))
+                continue;
+            for (const QPointer<TermWidget> &term : std::as_const(terminals))
+            {
+                if (term && findParent<TermWidgetHolder>(term.data()) == holder)
+                    holder->splitCollapse(term);
+            }
+        }
+
+        for (const QPointer<MainWindow> &wnd : std::as_const(windows))
+        {
+            QList<TermWidgetHolder*> tabs;
+            for (TermWidgetHolder *holder : std::as_const(closingTabs))
+            {
+                if (findParent<MainWindow>(holder) == wnd)
+                    tabs << holder;
+            }
+            if (tabs.isEmpty())
+                continue;
+            TabWidget *tabWidget = findParent<TabWidget>(tabs.constFirst());
+            if (tabWidget->count() == tabs.size())
+                wnd->closeWithoutPrompt();
+            else
+                tabWidget->removeTabs(tabs);
+        }
+        if (action == QLatin1String("closeTab"))
+            count = closingTabs.size();
+    }
+
+    for (const QPointer<MainWindow> &wnd : std::as_const(windows))
+    {
+        if (wnd)
+            wnd->setUpdatesEnabled(true);
+    }
+    return count;
+}
+
 #ifdef HAVE_QDBUS
 void QTerminalApp::registerOnDbus(bool dropDown, QString dbus_id)
 {
@@ -336,6 +520,11 @@ void QTerminalApp::registerOnDbus(bool dropDown, QString dbus_id)
         return;
     }
 
+    // settings written by other instances
+    QDBusConnection::sessionBus().connect(QString(), QStringLiteral("/settings"),
+                                          QStringLiteral("org.lxqt.QTerminal.Settings"), QStringLiteral("settingsChanged"),
+                                          this, SLOT(applySettings(QString,QVariantMap)));
+
     if (dropDown)
     {
         if (!QDBusConnection::sessionBus().registerService(QLatin1String(serviceName)))
@@ -361,6 +550,15 @@ void QTerminalApp::registerOnDbus(bool dropDown, QString dbus_id)
     }
 }
 
+void QTerminalApp::applySettings(const QString &file, const QVariantMap &changes)
+{
+    if (!Properties::Instance()->applyChanges(file, changes))
+        return;
+    for (MainWindow *wnd : std::as_const(m_windowList))
+        wnd->propertiesChanged();
+    Properties::Instance()->clearChanges();
+}
+
 QList<QDBusObjectPath> QTerminalApp::getWindows()
 {
     QList<QDBusObjectPath> windows;
@@ -371,28 +569,8 @@ QList<QDBusObjectPath> QTerminalApp::getWindows()
     return windows;
 }
 
-static QDBusObjectPath spawnNewProcess(const QString &dbus_id, const QString &shell_command, const QString& workdir, int columns, int lines)
-{
-    QStringList args;
-    args <<  QStringLiteral("-i") << dbus_id;
-    if (columns > 0 && lines > 0)
-        args <<  QStringLiteral("-s") << QStringLiteral("%1x%2").arg(columns).arg(lines);
-    args <<  QStringLiteral("-w") << workdir;
-    QString profile = Properties::Instance()->profile();
-    if (!profile.isEmpty())
-        args << QStringLiteral("-p") << profile;
-    args <<  QStringLiteral("-e") << shell_command;
-    QProcess::startDetached(QCoreApplication::applicationFilePath(), args);
-    return QDBusObjectPath();
-}
-
 QDBusObjectPath QTerminalApp::newWindow(const QString &dbus_id, const QString &shell_command, const QString& workdir, int columns, int lines)
 {
-    // dropDown can have only one window
-    for (MainWindow *wnd : m_windowList)
-        if (wnd->dropMode())
-            return spawnNewProcess(dbus_id, shell_command, workdir.isEmpty() ? m_workDir : workdir, columns, lines);
-
     TerminalConfig cfg = TerminalConfig(workdir.isEmpty() ? m_workDir : workdir, parse_command(shell_command));
     MainWindow *wnd = newWindow(false, cfg, dbus_id);
     assert(wnd != nullptr);
@@ -404,11 +582,6 @@ QDBusObjectPath QTerminalApp::newWindow(const QString &dbus_id, const QString &s
 QDBusObjectPath QTerminalApp::newWindow(const QHash<QString,QVariant> &termArgs)
 {
     TerminalConfig cfg = TerminalConfig::fromDbus(termArgs);
-
-    for (MainWindow *wnd : m_windowList)
-        if (wnd->dropMode())
-            return spawnNewProcess(QString(), cfg.getShell().join(QStringLiteral(" ")), cfg.getWorkingDirectory(), 0, 0);
-
     MainWindow *wnd = newWindow(false, cfg);
     assert(wnd != nullptr);
     return wnd->getDbusPath();
@@ -423,20 +596,18 @@ QDBusObjectPath QTerminalApp::getActiveWindow()
 }
 
 bool QTerminalApp::isDropMode() {
-  if (m_windowList.count() == 0) {
-    return false;
-  }
-  MainWindow *wnd = m_windowList.at(0);
-  return wnd->dropMode();
+  return m_hostsDropdown;
 }
 
 bool QTerminalApp::toggleDropdown() {
-  if (m_windowList.count() == 0) {
+  if (!m_hostsDropdown) {
     return false;
   }
-  MainWindow *wnd = m_windowList.at(0);
-  if (!wnd->dropMode()) {
-    return false;
+  MainWindow *wnd = dropdownWindow();
+  if (wnd == nullptr) {
+    // closed while other windows kept the process running
+    TerminalConfig cfg(m_workDir, QStringList());
+    wnd = new MainWindow(cfg, true);
   }
   wnd->showHide();
   return true;
@@ -24,9 +24,10 @@
 #include <QMessageBox>
 #include <QStandardPaths>
 #include <QTimer>
-#include <functional>
 #include <QGuiApplication>
 #include <QActionGroup>
+#include <QLoggingCategory>
+#include <QEventLoopLocker>
 
 #ifdef HAVE_QDBUS
 #include <QtDBus/QtDBus>
@@ -41,6 +42,8 @@
 #include "properties.h"
 #include "propertiesdialog.h"
 #include "bookmarkswidget.h"
+#include "bulkactiondialog.h"
+#include "commandpalette.h"
 #include "qterminalapp.h"
 #include "dbusaddressable.h"
 #include "qterminalutils.h"
@@ -48,8 +51,7 @@
 #include <LayerShellQt/Shell>
 #include <LayerShellQt/Window>
 
-typedef std::function<bool(MainWindow&, QAction *)> checkfn;
-Q_DECLARE_METATYPE(checkfn)
+Q_LOGGING_CATEGORY(lcDropdown, "qterminal.dropdown")
 
 MainWindow::MainWindow(TerminalConfig &cfg,
                        bool dropMode,
@@ -67,9 +69,14 @@ MainWindow::MainWindow(TerminalConfig &cfg,
       settingOwner(nullptr),
       presetsMenu(nullptr),
       m_config(cfg),
+      m_commandPalette(nullptr),
       m_dropLockButton(nullptr),
       m_dropMode(dropMode),
-      m_layerWindow(nullptr)
+      m_layerWindow(nullptr),
+      m_titleTimer(new QTimer(this)),
+      m_titlePending(false),
+      m_enabledForTabs(-1),
+      m_enabledForTerminals(-1)
 {
 #ifdef HAVE_QDBUS
     registerAdapter<WindowAdaptor, MainWindow>(this);
@@ -130,6 +137,10 @@ MainWindow::MainWindow(TerminalConfig &cfg,
         }
     }
 
+    m_titleTimer->setSingleShot(true);
+    m_titleTimer->setInterval(100);
+    connect(m_titleTimer, &QTimer::timeout, this, &MainWindow::titleTimeout);
+
     consoleTabulator->setAutoFillBackground(true);
     connect(consoleTabulator, &TabWidget::closeLastTabNotification, this, &MainWindow::close);
     consoleTabulator->setTabPosition((QTabWidget::TabPosition)Properties::Instance()->tabsPos);
@@ -139,13 +150,22 @@ MainWindow::MainWindow(TerminalConfig &cfg,
     for (const auto& action : menuBarActions)
         menubarOrigTexts << action->text();
 
+    CommandPaletteIndex::Instance()->addTabWidget(consoleTabulator);
+
+    setupActions();
     // apply props
     propertiesChanged();
 
     setupCustomDirs();
 
     connect(consoleTabulator, &TabWidget::currentTitleChanged, this, &MainWindow::onCurrentTitleChanged);
-    connect(menu_Actions, &QMenu::aboutToShow, this, &MainWindow::updateDisabledActions);
+    // the enabled state of actions follows the number of tabs and subterminals
+    connect(consoleTabulator, &TabWidget::tabAdded, this, [this](TermWidgetHolder *holder) {
+        connect(holder, &TermWidgetHolder::terminalsChanged, this, &MainWindow::updateDisabledActions);
+        updateDisabledActions();
+    });
+    connect(consoleTabulator, &TabWidget::tabRemoved, this, &MainWindow::updateDisabledActions);
+    connect(consoleTabulator, &QTabWidget::currentChanged, this, &MainWindow::updateDisabledActions);
 
     /* The tab should be added after all changes are made to
        the main window; otherwise, the initial prompt might
@@ -153,16 +173,33 @@ MainWindow::MainWindow(TerminalConfig &cfg,
     addNewTab(m_config, dbus_id);
 }
 
-void MainWindow::rebuildActions()
+void MainWindow::setupActions()
 {
-    // Delete all setting-related QObjects
-    delete settingOwner;
     settingOwner = new QObject(this);
 
-    // Then create them again
     setup_FileMenu_Actions();
     setup_ActionsMenu_Actions();
     setup_ViewMenu_Actions();
+
+    CommandPaletteIndex::Instance()->setActions(this, actions);
+    updateDisabledActions();
+}
+
+void MainWindow::updateActions()
+{
+    // only the shortcuts that really changed are registered again
+    const QMap<QString, QString> sequences = Properties::Instance()->getShortcuts(m_defaultShortcuts);
+    for (auto it = actions.cbegin(); it != actions.cend(); ++it)
+    {
+        QList<QKeySequence> shortcuts;
+        const auto strings = sequences.value(it.key()).split(QLatin1Char('|'));
+        for (const QString &sequenceString : strings)
+            shortcuts.append(QKeySequence::fromString(sequenceString));
+        if (it.value()->shortcuts() != shortcuts)
+            it.value()->setShortcuts(shortcuts);
+    }
+
+    updateViewMenu();
 }
 
 MainWindow::~MainWindow()
@@ -205,7 +242,23 @@ void MainWindow::enableDropMode()
 
     setDropShortcut(Properties::Instance()->dropShortCut);
     setDropLockShortCut(Properties::Instance()->dropLockShortCut);
+
+    connect(qApp, &QGuiApplication::screenAdded, this, [this](QScreen *screen) {
+        connect(screen, &QScreen::availableGeometryChanged, this, &MainWindow::invalidateDropGeometry);
+        invalidateDropGeometry();
+    });
+    connect(qApp, &QGuiApplication::screenRemoved, this, &MainWindow::invalidateDropGeometry);
+    const auto screens = QGuiApplication::screens();
+    for (QScreen *screen : screens)
+        connect(screen, &QScreen::availableGeometryChanged, this, &MainWindow::invalidateDropGeometry);
+
+    // the hidden dropdown keeps the process alive when normal windows are closed
+    m_quitLock.reset(new QEventLoopLocker);
+
     realign();
+    // create the native window now, so that toggling only has to map it
+    winId();
+    ensurePolished();
 }
 
 void MainWindow::setDropShortcut(const QKeySequence& dropShortCut)
@@ -234,6 +287,7 @@ void MainWindow::setup_Action(const char *name, QAction *action, const char *def
     QList<QKeySequence> shortcuts;
 
     actions[QLatin1String(name)] = action;
+    m_defaultShortcuts[QLatin1String(name)] = QLatin1String(defaultShortcut);
     const auto sequences = Properties::Instance()->getShortcut(QLatin1String(name), QLatin1String(defaultShortcut)).split(QLatin1Char('|'));
     for (const QString &sequenceString : sequences)
         shortcuts.append(QKeySequence::fromString(sequenceString));
@@ -250,17 +304,16 @@ void MainWindow::setup_Action(const char *name, QAction *action, const char *def
         menu->addAction(actions[QLatin1String(name)]);
 
     if (!data.isNull())
+    {
         actions[QLatin1String(name)]->setData(data);
+        m_dependentActions << actions[QLatin1String(name)];
+    }
 }
 
 void MainWindow::setup_ActionsMenu_Actions()
 {
     QVariant data;
 
-    const checkfn checkTabs = &MainWindow::hasMultipleTabs;
-    const checkfn checkSubterminals = &MainWindow::hasMultipleSubterminals;
-    const checkfn checkHasIndexedTab = &MainWindow::hasIndexedTab;
-
     menu_Actions->clear();
 
     setup_Action(CLEAR_TERMINAL, new QAction(QIcon::fromTheme(QStringLiteral("edit-clear")), tr("&Clear Active Terminal"), settingOwner),
@@ -268,7 +321,7 @@ void MainWindow::setup_ActionsMenu_Actions()
 
     menu_Actions->addSeparator();
 
-    data.setValue(checkTabs);
+    data = MultipleTabs;
 
     setup_Action(TAB_NEXT, new QAction(QIcon::fromTheme(QStringLiteral("go-next")), tr("&Next Tab"), settingOwner),
                  TAB_NEXT_SHORTCUT, consoleTabulator, SLOT(switchToRight()), menu_Actions, data);
@@ -288,7 +341,7 @@ void MainWindow::setup_ActionsMenu_Actions()
     setup_Action(MOVE_RIGHT, new QAction(tr("Move Tab &Right"), settingOwner),
                  MOVE_RIGHT_SHORTCUT, consoleTabulator, SLOT(moveRight()), menu_Actions, data);
 
-    data.setValue(checkHasIndexedTab);
+    data = IndexedTab;
 
     const QString textBase = tr("Tab");
     QMenu *menu_GoTo = new QMenu(tr("Go to"), menu_Actions);
@@ -310,7 +363,7 @@ void MainWindow::setup_ActionsMenu_Actions()
     setup_Action(SPLIT_VERTICAL, new QAction(tr("Split Vie&w Left-Right"), settingOwner),
                  nullptr, consoleTabulator, SLOT(splitVertically()), menu_Actions);
 
-    data.setValue(checkSubterminals);
+    data = MultipleSubterminals;
 
     setup_Action(SUB_COLLAPSE, new QAction(tr("&Close Subterminal"), settingOwner),
                  nullptr, consoleTabulator, SLOT(splitCollapse()), menu_Actions, data);
@@ -357,6 +410,12 @@ void MainWindow::setup_ActionsMenu_Actions()
     setup_Action(HANDLE_HISTORY, new QAction(QIcon::fromTheme(QStringLiteral("handle-history")), tr("Handle history..."), settingOwner),
                  NULL, this, SLOT(handleHistory()), menu_Actions);
 
+    setup_Action(COMMAND_PALETTE, new QAction(QIcon::fromTheme(QStringLiteral("system-search")), tr("Command &Palette..."), settingOwner),
+                 COMMAND_PALETTE_SHORTCUT, this, SLOT(showCommandPalette()), menu_Actions);
+
+    setup_Action(APPLY_TO_TERMINALS, new QAction(tr("&Apply to Terminals..."), settingOwner),
+                 nullptr, this, SLOT(showBulkActionDialog()), menu_Actions);
+
 #if 0
     act = new QAction(this);
     act->setSeparator(true);
@@ -429,28 +488,14 @@ void MainWindow::setup_ViewMenu_Actions()
     QAction *hideBordersAction = new QAction(tr("&Hide Window Borders"), settingOwner);
     hideBordersAction->setCheckable(true);
     hideBordersAction->setVisible(!m_dropMode);
-
-    hideBordersAction->setChecked(Properties::Instance()->borderless);
-    if (!m_dropMode) // dropdown mode doesn't need any change
-    {
-        if (!testAttribute(Qt::WA_WState_Created)) // called by c-tor
-        {
-            if (Properties::Instance()->borderless)
-                setWindowFlags(windowFlags() ^ Qt::FramelessWindowHint);
-        }
-        else if (Properties::Instance()->borderless != windowFlags().testFlag(Qt::FramelessWindowHint))
-            QTimer::singleShot(0, this, &MainWindow::toggleBorderless); // called by PropertiesDialog
-    }
     setup_Action(HIDE_WINDOW_BORDERS, hideBordersAction,
                  nullptr, this, SLOT(toggleBorderless()), menu_Window);
 
     QAction *showTabBarAction = new QAction(tr("&Show Tab Bar"), settingOwner);
     //toggleTabbar->setObjectName("toggle_TabBar");
     showTabBarAction->setCheckable(true);
-    showTabBarAction->setChecked(!Properties::Instance()->tabBarless);
     setup_Action(SHOW_TAB_BAR, showTabBarAction,
                  nullptr, this, SLOT(toggleTabBar()), menu_Window);
-    toggleTabBar();
 
     QAction *toggleFullscreen = new QAction(tr("Fullscreen"), settingOwner);
     toggleFullscreen->setCheckable(true);
@@ -480,9 +525,6 @@ void MainWindow::setup_ViewMenu_Actions()
     }
 
 
-    if( tabPosition->actions().count() > Properties::Instance()->tabsPos )
-        tabPosition->actions().at(Properties::Instance()->tabsPos)->setChecked(true);
-
     connect(tabPosition, &QActionGroup::triggered,
             consoleTabulator, &TabWidget::changeTabPosition);
 
@@ -564,6 +606,28 @@ void MainWindow::setup_ViewMenu_Actions()
     menu_Window->addMenu(keyboardCursorShapeMenu);
 }
 
+// the parts of the View menu that follow the settings
+void MainWindow::updateViewMenu()
+{
+    actions[QLatin1String(HIDE_WINDOW_BORDERS)]->setChecked(Properties::Instance()->borderless);
+    if (!m_dropMode) // dropdown mode doesn't need any change
+    {
+        if (!testAttribute(Qt::WA_WState_Created)) // called by c-tor
+        {
+            if (Properties::Instance()->borderless)
+                setWindowFlags(windowFlags() ^ Qt::FramelessWindowHint);
+        }
+        else if (Properties::Instance()->borderless != windowFlags().testFlag(Qt::FramelessWindowHint))
+            QTimer::singleShot(0, this, &MainWindow::toggleBorderless); // called by PropertiesDialog
+    }
+
+    actions[QLatin1String(SHOW_TAB_BAR)]->setChecked(!Properties::Instance()->tabBarless);
+    toggleTabBar();
+
+    if( tabPosition->actions().count() > Properties::Instance()->tabsPos )
+        tabPosition->actions().at(Properties::Instance()->tabsPos)->setChecked(true);
+}
+
 void MainWindow::setupCustomDirs()
 {
     const QString appName = QCoreApplication::applicationName();
@@ -651,12 +715,21 @@ bool MainWindow::closePrompt(const QString &title, const QString &text)
     return res;
 }
 
+void MainWindow::closeWithoutPrompt()
+{
+    m_closeWithoutPrompt = true;
+    close();
+    m_closeWithoutPrompt = false;
+}
+
 void MainWindow::closeEvent(QCloseEvent *ev)
 {
-    if (!Properties::Instance()->askOnExit
+    if (m_closeWithoutPrompt
+        || !Properties::Instance()->askOnExit
         || consoleTabulator->count() == 0
         // the session is ended explicitly (e.g., by ctrl-d); prompt doesn't make sense
-        || consoleTabulator->terminalHolder()->findChildren<TermWidget*>().count() == 0
+        || (consoleTabulator->terminalHolder()->isMaterialized()
+            && consoleTabulator->terminalHolder()->findChildren<TermWidget*>().count() == 0)
         // there is no running process
         || !consoleTabulator->hasRunningProcess()
         // ask user for canceling otherwise
@@ -681,12 +754,9 @@ void MainWindow::closeEvent(QCloseEvent *ev)
                 Properties::Instance()->mainWindowState = saveState();
             }
         }
-        rebuildActions(); // shortcuts may have changed by another running instance
+        updateActions(); // shortcuts may have changed by another running instance
         Properties::Instance()->saveSettings();
-        for (int i = consoleTabulator->count(); i > 0; --i)
-        {
-            consoleTabulator->removeTab(i - 1);
-        }
+        consoleTabulator->closeAllTabs();
         ev->accept();
         // closing hidden windows does not trigger "quitOnLastWindowClosed : bool", as documented
         //      If this property is true, the application will attempt to quit when the last **visible** primary
@@ -726,17 +796,30 @@ void MainWindow::actProperties_triggered()
 
 void MainWindow::propertiesChanged()
 {
-    rebuildActions();
+    // settings applied from another instance only touch what they changed
+    const Properties *props = Properties::Instance();
+    auto changed = [props](const char *key) {
+        return props->isChanged(QLatin1String(key));
+    };
 
-    QApplication::setStyle(Properties::Instance()->guiStyle);
-    consoleTabulator->setTabPosition((QTabWidget::TabPosition)Properties::Instance()->tabsPos);
-    consoleTabulator->propertiesChanged();
-    setDropShortcut(Properties::Instance()->dropShortCut);
-    setDropLockShortCut(Properties::Instance()->dropLockShortCut);
+    if (props->isGroupChanged(QStringLiteral("Shortcuts/")))
+        updateActions();
+    else
+        updateViewMenu();
 
+    if (changed("guiStyle"))
+        QApplication::setStyle(Properties::Instance()->guiStyle);
+    if (changed("TabsPosition"))
+        consoleTabulator->setTabPosition((QTabWidget::TabPosition)Properties::Instance()->tabsPos);
+    consoleTabulator->propertiesChanged();
+    if (changed("DropMode/ShortCut"))
+        setDropShortcut(Properties::Instance()->dropShortCut);
+    if (changed("DropMode/KeepOpenShortCut"))
+        setDropLockShortCut(Properties::Instance()->dropLockShortCut);
 
     const auto menuBarActions = m_menuBar->actions();
-    if (Properties::Instance()->noMenubarAccel)
+    const bool accelChanged = changed("NoMenubarAccel");
+    if (accelChanged && Properties::Instance()->noMenubarAccel)
     {
         for (auto& action : menuBarActions)
         {
@@ -745,7 +828,7 @@ void MainWindow::propertiesChanged()
             action->setText(txt);
         }
     }
-    else if (menubarOrigTexts.size() == menuBarActions.size())
+    else if (accelChanged && menubarOrigTexts.size() == menuBarActions.size())
     {
         int i = 0;
         for (auto& action : menuBarActions)
@@ -755,22 +838,32 @@ void MainWindow::propertiesChanged()
         }
     }
 
-    m_menuBar->setVisible(Properties::Instance()->menuVisible);
+    if (changed("MenuVisible"))
+        m_menuBar->setVisible(Properties::Instance()->menuVisible);
 
-    m_bookmarksDock->setVisible(Properties::Instance()->useBookmarks
-                                && Properties::Instance()->bookmarksVisible);
-    actions[QLatin1String(TOGGLE_BOOKMARKS)]->setVisible(Properties::Instance()->useBookmarks);
+    if (changed("UseBookmarks") || changed("BookmarksVisible"))
+    {
+        m_bookmarksDock->setVisible(Properties::Instance()->useBookmarks
+                                    && Properties::Instance()->bookmarksVisible);
+        actions[QLatin1String(TOGGLE_BOOKMARKS)]->setVisible(Properties::Instance()->useBookmarks);
+    }
 
-    if (Properties::Instance()->useBookmarks)
+    if (Properties::Instance()->useBookmarks && (changed("UseBookmarks") || changed("BookmarksFile")))
     {
         qobject_cast<BookmarksWidget*>(m_bookmarksDock->widget())->setup();
     }
 
-    onCurrentTitleChanged(consoleTabulator->currentIndex());
+    if (changed("ChangeWindowTitle") || changed("ChangeWindowIcon"))
+        onCurrentTitleChanged(consoleTabulator->currentIndex());
 
-    setKeepOpen(Properties::Instance()->dropKeepOpen);
+    if (changed("DropMode/KeepOpen"))
+        setKeepOpen(Properties::Instance()->dropKeepOpen);
 
-    realign();
+    if (changed("DropMode/Width") || changed("DropMode/Height"))
+    {
+        invalidateDropGeometry();
+        realign();
+    }
 }
 
 void MainWindow::realign()
@@ -781,19 +874,17 @@ void MainWindow::realign()
         {
             return; // done in showEvent
         }
-        QScreen *appScreen = QGuiApplication::screenAt(QCursor::pos());
-        if(appScreen == nullptr)
+        // only look the screen up again when the cursor has left the last one
+        const QPoint pos = QCursor::pos();
+        if (m_dropScreen.isNull() || !m_dropScreen->geometry().contains(pos))
         {
-            appScreen = QGuiApplication::primaryScreen();
+            m_dropScreen = QGuiApplication::screenAt(pos);
+            if (m_dropScreen.isNull())
+            {
+                m_dropScreen = QGuiApplication::primaryScreen();
+            }
         }
-        const QRect desktop = appScreen->availableGeometry();
-        QRect g = QRect(desktop.x(),
-                        desktop.y(),
-                        desktop.width()  * Properties::Instance()->dropWidth  / 100,
-                        desktop.height() * Properties::Instance()->dropHeight / 100);
-        g.moveCenter(desktop.center());
-        // do not use 0 here - we need to calculate with potential panel on top
-        g.moveTop(desktop.top());
+        const QRect g = dropGeometry(m_dropScreen);
         if (g != geometry())
         {
             setGeometry(g);
@@ -801,6 +892,30 @@ void MainWindow::realign()
     }
 }
 
+QRect MainWindow::dropGeometry(QScreen *screen)
+{
+    auto it = m_dropGeometry.constFind(screen);
+    if (it != m_dropGeometry.constEnd())
+        return it.value();
+
+    const QRect desktop = screen->availableGeometry();
+    QRect g = QRect(desktop.x(),
+                    desktop.y(),
+                    desktop.width()  * Properties::Instance()->dropWidth  / 100,
+                    desktop.height() * Properties::Instance()->dropHeight / 100);
+    g.moveCenter(desktop.center());
+    // do not use 0 here - we need to calculate with potential panel on top
+    g.moveTop(desktop.top());
+    m_dropGeometry.insert(screen, g);
+    return g;
+}
+
+void MainWindow::invalidateDropGeometry()
+{
+    m_dropGeometry.clear();
+    m_dropScreen.clear();
+}
+
 void MainWindow::updateActionGroup(QAction *a)
 {
     if (a->parent()->objectName() == tabPosMenu->objectName()) {
@@ -811,13 +926,9 @@ void MainWindow::updateActionGroup(QAction *a)
 void MainWindow::showHide()
 {
     // don't toggle the drop-down terminal when it has a modal dialog
-    const auto dialogs = findChildren<QDialog*>();
-    for (const auto& dialog : dialogs)
+    if (hasModalDialog())
     {
-        if(dialog->isModal())
-        {
-            return;
-        }
+        return;
     }
 
     if (isVisible())
@@ -833,8 +944,11 @@ void MainWindow::showHide()
         {
             a->setChecked(false);
         }
+        m_showTimer.start();
+        watchFirstFrame();
         realign();
         show();
+        raise();
         activateWindow();
     }
 }
@@ -859,6 +973,23 @@ void MainWindow::find()
     consoleTabulator->terminalHolder()->currentTerminal()->impl()->toggleShowSearchBar();
 }
 
+void MainWindow::showCommandPalette()
+{
+    if (!m_commandPalette)
+    {
+        m_commandPalette = new CommandPalette(this);
+        connect(m_commandPalette, &CommandPalette::callCommand,
+                this, &MainWindow::bookmarksWidget_callCommand);
+    }
+    m_commandPalette->popup();
+}
+
+void MainWindow::showBulkActionDialog()
+{
+    BulkActionDialog dialog(this);
+    dialog.exec();
+}
+
 void MainWindow::handleHistory()
 {
     const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
@@ -870,7 +1001,7 @@ void MainWindow::handleHistory()
         return;
     }
     TermWidgetImpl *impl = consoleTabulator->terminalHolder()->currentTerminal()->impl();
-    impl->saveHistory(&file);
+    impl->saveFullHistory(&file);
     file.close();
     QStringList args = Properties::Instance()->handleHistoryCommand.split(QLatin1Char(' '), Qt::SkipEmptyParts);
     if (args.isEmpty())
@@ -946,38 +1077,80 @@ void MainWindow::showEvent(QShowEvent* event)
 
     if (m_initialSize.isValid())
     {
-        QList<TermWidget*> twl = findChildren<TermWidget*>();
-        if (twl.size() > 0)
-            twl.at(0)->setSize(m_initialSize.width(), m_initialSize.height());
+        if (TermWidgetHolder *holder = consoleTabulator->terminalHolder())
+            holder->currentTerminal()->setSize(m_initialSize.width(), m_initialSize.height());
         m_initialSize = QSize();
     }
 
     QMainWindow::showEvent(event);
 }
 
-void MainWindow::newTerminalWindow()
+bool MainWindow::hasModalDialog() const
 {
-    TerminalConfig cfg;
-    TermWidgetHolder *ch = consoleTabulator->terminalHolder();
-    if (ch)
-        cfg.provideCurrentDirectory(ch->currentTerminal()->impl()->workingDirectory());
+    QWidget *modal = qApp->activeModalWidget();
+    for (QWidget *w = modal; w != nullptr; w = w->parentWidget())
+    {
+        if (w == this)
+            return true;
+    }
+    return false;
+}
 
-    if (m_dropMode)
-    { // the dropdown process has only one (dropdown) main window
-        QStringList args;
-        args <<  QStringLiteral("-w") << cfg.getWorkingDirectory();
-        QString profile = Properties::Instance()->profile();
-        if (!profile.isEmpty())
+void MainWindow::watchFirstFrame()
+{
+    if (m_frameWatch)
+        m_frameWatch->removeEventFilter(this);
+    m_frameWatch = nullptr;
+
+    TermWidgetHolder *holder = consoleTabulator->terminalHolder();
+    if (holder == nullptr)
+        return;
+    if (holder->isMaterialized())
+    {
+        const auto kids = holder->findChildren<QWidget*>();
+        for (QWidget *kid : kids)
         {
-            args << QStringLiteral("-p") << profile;
+            if (kid->inherits("Konsole::TerminalDisplay") && kid->isVisibleTo(holder))
+            {
+                m_frameWatch = kid;
+                break;
+            }
         }
-        QProcess::startDetached(QStringLiteral("qterminal"), args);
     }
-    else
+    // a tab that is not built yet shows its empty holder first
+    if (!m_frameWatch)
+        m_frameWatch = holder;
+    m_frameWatch->installEventFilter(this);
+}
+
+bool MainWindow::eventFilter(QObject *obj, QEvent *event)
+{
+    if (event->type() == QEvent::Paint && obj == m_frameWatch)
     {
-        MainWindow *w = new MainWindow(cfg, false);
-        w->show();
+        m_frameWatch->removeEventFilter(this);
+        m_frameWatch = nullptr;
+        // the frame is flushed when the paint that is about to happen returns
+        QTimer::singleShot(0, this, [this] {
+            if (m_showTimer.isValid())
+            {
+                qCDebug(lcDropdown, "shown in %.2f ms", m_showTimer.nsecsElapsed() / 1000000.0);
+                m_showTimer.invalidate();
+            }
+        });
     }
+    return QMainWindow::eventFilter(obj, event);
+}
+
+void MainWindow::newTerminalWindow()
+{
+    TerminalConfig cfg;
+    TermWidgetHolder *ch = consoleTabulator->terminalHolder();
+    if (ch)
+        cfg.provideCurrentDirectory(ch->currentDirectory());
+
+    // also from the dropdown, whose process can host normal windows
+    MainWindow *w = new MainWindow(cfg, false);
+    w->show();
 }
 
 void MainWindow::bookmarksWidget_callCommand(const QString& cmd)
@@ -1023,57 +1196,108 @@ void MainWindow::addNewTab(TerminalConfig cfg, const QString &dbus_id)
     // disabled actions are updated by TabWidget::onCurrentChanged()
 }
 
-void MainWindow::onCurrentTitleChanged(int index)
+void MainWindow::onCurrentTitleChanged(int /*index*/)
+{
+    // the window manager gets at most one title per interval, the latest one
+    if (m_titleTimer->isActive())
+    {
+        m_titlePending = true;
+        return;
+    }
+    updateWindowTitle();
+    m_titleTimer->start();
+}
+
+void MainWindow::titleTimeout()
+{
+    if (!m_titlePending)
+        return;
+    m_titlePending = false;
+    updateWindowTitle();
+    m_titleTimer->start();
+}
+
+void MainWindow::updateWindowTitle()
 {
     QString title;
     QIcon icon;
+    const int index = consoleTabulator->currentIndex();
     if (-1 != index)
     {
         title = consoleTabulator->tabText(index);
         icon = consoleTabulator->tabIcon(index);
     }
-    setWindowTitle(title.isEmpty() || !Properties::Instance()->changeWindowTitle ? QStringLiteral("QTerminal") : title);
-    setWindowIcon(icon.isNull() || !Properties::Instance()->changeWindowIcon ? QIcon::fromTheme(QStringLiteral("utilities-terminal")) : icon);
+    if (title.isEmpty() || !Properties::Instance()->changeWindowTitle)
+        title = QStringLiteral("QTerminal");
+    if (icon.isNull() || !Properties::Instance()->changeWindowIcon)
+    {
+        if (m_defaultIcon.isNull())
+            m_defaultIcon = QIcon::fromTheme(QStringLiteral("utilities-terminal"));
+        icon = m_defaultIcon;
+    }
+    if (title != windowTitle())
+        setWindowTitle(title);
+    if (icon.cacheKey() != windowIcon().cacheKey())
+        setWindowIcon(icon);
 }
 
-bool MainWindow::hasMultipleTabs(QAction *)
+void MainWindow::updateDisabledActions()
 {
-    return consoleTabulator->findChildren<TermWidgetHolder*>().count() > 1;
-}
+    const int tabs = consoleTabulator->count();
+    TermWidgetHolder *holder = consoleTabulator->terminalHolder();
+    const int terminals = holder ? holder->terminalCount() : 0;
+    // called on every change of tabs or subterminals, but rarely does anything
+    if (tabs == m_enabledForTabs && terminals == m_enabledForTerminals)
+        return;
+    m_enabledForTabs = tabs;
+    m_enabledForTerminals = terminals;
 
-bool MainWindow::hasMultipleSubterminals(QAction *)
-{
-    return consoleTabulator->terminalHolder()->findChildren<TermWidget*>().count() > 1;
+    for (QAction *action : std::as_const(m_dependentActions))
+    {
+        switch (action->data().toInt())
+        {
+        case MultipleTabs:
+            action->setEnabled(tabs > 1);
+            break;
+        case IndexedTab:
+            action->setEnabled(tabs >= action->property("tab").toInt());
+            break;
+        case MultipleSubterminals:
+            action->setEnabled(terminals > 1);
+            break;
+        }
+    }
 }
 
-bool MainWindow::hasIndexedTab(QAction *action)
+QMap< QString, QAction * >& MainWindow::leaseActions() {
+    return actions;
+}
+TermWidgetHolder *MainWindow::addTab(TerminalConfig &cfg, const QString &dbus_id)
 {
-    bool ok = false;
-    const int index = action->property("tab").toInt(&ok);
-    Q_ASSERT(ok);
-    static_cast<void>(ok);
-    return consoleTabulator->findChildren<TermWidgetHolder*>().count() >= index;
+    int idx = consoleTabulator->addNewTab(cfg, dbus_id);
+    return qobject_cast<TermWidgetHolder*>(consoleTabulator->widget(idx));
 }
 
-void MainWindow::updateDisabledActions()
+QVariantMap MainWindow::layoutInfo()
 {
-    std::function<void(const QList<QAction *> &)> enableActions = [this, &enableActions](const QList<QAction *> &actions) {
-        for (QAction *action : actions) {
-            if (!action->data().isNull()) {
-                const checkfn check = action->data().value<checkfn>();
-                action->setEnabled(check(*this, action));
-            } else if (QMenu *menu = action->menu()) {
-                enableActions(menu->actions());
-            }
-        }
-    };
+    QVariantList tabs;
+    for (int i = 0; i < consoleTabulator->count(); ++i)
+    {
+        TermWidgetHolder *holder = qobject_cast<TermWidgetHolder*>(consoleTabulator->widget(i));
+        QVariantMap tab = holder->layoutInfo();
+        tab[QStringLiteral("label")] = consoleTabulator->tabText(i);
+        tabs << tab;
+    }
 
-    enableActions(menu_Actions->actions());
+    QVariantMap info;
+    info[QStringLiteral("window")] = getDbusPathString();
+    info[QStringLiteral("dropMode")] = m_dropMode;
+    info[QStringLiteral("tabs")] = tabs;
+    if (TermWidgetHolder *current = qobject_cast<TermWidgetHolder*>(consoleTabulator->currentWidget()))
+        info[QStringLiteral("activeTab")] = current->getDbusPathString();
+    return info;
 }
 
-QMap< QString, QAction * >& MainWindow::leaseActions() {
-    return actions;
-}
 #ifdef HAVE_QDBUS
 
 QDBusObjectPath MainWindow::getActiveTab()
@@ -1095,15 +1319,13 @@ QList<QDBusObjectPath> MainWindow::getTabs()
 QDBusObjectPath MainWindow::newTab(const QHash<QString,QVariant> &termArgs)
 {
     TerminalConfig cfg = TerminalConfig::fromDbus(termArgs);
-    int idx = consoleTabulator->addNewTab(cfg);
-    return qobject_cast<TermWidgetHolder*>(consoleTabulator->widget(idx))->getDbusPath();
+    return addTab(cfg)->getDbusPath();
 }
 
 QDBusObjectPath MainWindow::newTab(const QString &dbus_id, const QString &shell_command, const QString& workdir)
 {
     TerminalConfig cfg = TerminalConfig(workdir.isEmpty() ? QTerminalApp::Instance()->getWorkingDirectory() : workdir, parse_command(shell_command));
-    int idx = consoleTabulator->addNewTab(cfg, dbus_id);
-    return qobject_cast<TermWidgetHolder*>(consoleTabulator->widget(idx))->getDbusPath();
+    return addTab(cfg, dbus_id)->getDbusPath();
 }
 
 
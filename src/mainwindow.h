@@ -23,16 +23,25 @@
 
 #include <QMainWindow>
 #include <QAction>
+#include <QElapsedTimer>
+#include <QPointer>
+
+#include <memory>
 
 #include "qxtglobalshortcut.h"
 #include "terminalconfig.h"
 #include "dbusaddressable.h"
 
+class TermWidgetHolder;
+
 namespace LayerShellQt {
     class Window;
 }
 
 class QToolButton;
+class QTimer;
+class QEventLoopLocker;
+class CommandPalette;
 
 class MainWindow : public QMainWindow, private Ui::mainWindow, public DBusAddressable
 {
@@ -47,9 +56,12 @@ public:
     bool dropMode() { return m_dropMode; }
     QMap<QString, QAction*> & leaseActions();
 
-    void rebuildActions();
+    // brings the actions created by setupActions() up to date with the settings
+    void updateActions();
 
     bool closePrompt(const QString &title, const QString &text);
+    // closes the window and its tabs without asking, even with running processes
+    void closeWithoutPrompt();
 
     void setInitialSize(QSize size) { m_initialSize = size; }
 
@@ -62,16 +74,19 @@ public:
     void activateOrHide();
     #endif
 
+    TermWidgetHolder *addTab(TerminalConfig &cfg, const QString &dbus_id = QString());
+    QVariantMap layoutInfo();
+
 protected:
      bool event(QEvent* event) override;
      void showEvent(QShowEvent* event) override;
+     bool eventFilter(QObject *obj, QEvent *event) override;
 
 private:
     QActionGroup *tabPosition, *scrollBarPosition, *keyboardCursorShape;
     QMenu *tabPosMenu, *scrollPosMenu, *keyboardCursorShapeMenu;
 
-    // A parent object for QObjects that are created dynamically based on settings
-    // Used to simplify the setting cleanup on reconfiguration: deleting settingOwner frees all related QObjects
+    // The parent of the actions created by setupActions()
     QObject *settingOwner;
 
     QMenu *presetsMenu;
@@ -79,13 +94,17 @@ private:
     QSize m_initialSize;
 
     QDockWidget *m_bookmarksDock;
+    CommandPalette *m_commandPalette;
 
     void setup_Action(const char *name, QAction *action, const char *defaultShortcut, const QObject *receiver,
                       const char *slot, QMenu *menu = nullptr, const QVariant &data = QVariant());
     QMap< QString, QAction * > actions;
+    QMap< QString, QString > m_defaultShortcuts;
 
     QStringList menubarOrigTexts;
 
+    void setupActions();
+    void updateViewMenu();
     void setup_FileMenu_Actions();
     void setup_ActionsMenu_Actions();
     void setup_ViewMenu_Actions();
@@ -97,23 +116,48 @@ private:
     void enableDropMode();
     QToolButton *m_dropLockButton;
     bool m_dropMode;
+    bool m_closeWithoutPrompt = false;
     LayerShellQt::Window *m_layerWindow;
     QxtGlobalShortcut m_dropShortcut;
+    std::unique_ptr<QEventLoopLocker> m_quitLock;
     void realign();
+    void updateWindowTitle();
+    void titleTimeout();
+    QTimer *m_titleTimer;
+    bool m_titlePending;
+    QIcon m_defaultIcon;
+    QRect dropGeometry(QScreen *screen);
+    void invalidateDropGeometry();
+    // dropdown geometry on each screen, computed when first needed
+    QHash<QScreen*, QRect> m_dropGeometry;
+    // the screen the dropdown was last shown on
+    QPointer<QScreen> m_dropScreen;
+    // from showHide() to the first painted frame of the terminal
+    QElapsedTimer m_showTimer;
+    QPointer<QWidget> m_frameWatch;
+    void watchFirstFrame();
+    bool hasModalDialog() const;
     void setDropShortcut(const QKeySequence& dropShortCut);
     void setDropLockShortCut(const QKeySequence& dropLockShortCut);
 
-    bool hasMultipleTabs(QAction *);
-    bool hasMultipleSubterminals(QAction *);
-    bool hasIndexedTab(QAction *action);
+    // what the enabled state of an action depends on, kept in its data
+    enum ActionCondition {
+        MultipleTabs = 1,
+        IndexedTab,
+        MultipleSubterminals
+    };
+    QList<QAction*> m_dependentActions;
+    // the counts the actions were last enabled for
+    int m_enabledForTabs;
+    int m_enabledForTerminals;
 
 public slots:
     void showHide();
     void updateDisabledActions();
+    void propertiesChanged();
 
 private slots:
     void on_consoleTabulator_currentChanged(int);
-    void propertiesChanged();
     void actAbout_triggered();
     void actProperties_triggered();
     void updateActionGroup(QAction *);
@@ -125,6 +169,8 @@ private slots:
     void showFullscreen(bool fullscreen);
     void setKeepOpen(bool value);
     void find();
+    void showCommandPalette();
+    void showBulkActionDialog();
 
     void newTerminalWindow();
     void bookmarksWidget_callCommand(const QString&);
@@ -16,13 +16,14 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
  ***************************************************************************/
 
-#include <qtermwidget.h>
-#include <cassert>
+#include <QWidget>
+
+#ifdef HAVE_QDBUS
+    #include <QtDBus/QtDBus>
+#endif
 
 #include "properties.h"
 #include "config.h"
-#include "mainwindow.h"
-#include "qterminalapp.h"
 
 Properties * Properties::m_instance = nullptr;
 
@@ -44,22 +45,39 @@ Properties::Properties(const QString& filename)
         m_settings = new QSettings(filename);
     //qDebug("Properties constructor called");
 
+    // QSettings writes through a temporary file that replaces the config file
+    m_settings->setAtomicSyncRequired(true);
+
+    m_saveTimer = new QTimer();
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(500);
+    QObject::connect(m_saveTimer, &QTimer::timeout, [this] {
+        flushSettings();
+    });
+
+    // a writer may touch the file several times; react once
+    m_reloadTimer = new QTimer();
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(200);
+    QObject::connect(m_reloadTimer, &QTimer::timeout, [this] {
+        if (m_settings)
+            fileChanged();
+    });
+
     m_watcher = new QFileSystemWatcher();
     m_watcher->addPath(m_settings->fileName());
-    QObject::connect(m_watcher, &QFileSystemWatcher::fileChanged, [this](const QString &path) {
-        if (m_settings)
-        {
-            m_settings->sync();
-            loadSettings();
-            if (!m_watcher->files().contains(path))
-                m_watcher->addPath(path);
-        }
+    QObject::connect(m_watcher, &QFileSystemWatcher::fileChanged, [this] {
+        m_reloadTimer->start();
     });
 }
 
 Properties::~Properties()
 {
     //qDebug("Properties destructor called");
+    if (m_saveTimer->isActive())
+        flushSettings();
+    delete m_saveTimer;
+    delete m_reloadTimer;
     delete m_settings;
     m_instance = nullptr;
     delete  m_watcher;
@@ -77,30 +95,10 @@ QFont Properties::defaultFont()
 
 void Properties::loadSettings()
 {
-    guiStyle = m_settings->value(QLatin1String("guiStyle"), QString()).toString();
-    if (!guiStyle.isNull())
-        QApplication::setStyle(guiStyle);
-
-    colorScheme = m_settings->value(QLatin1String("colorScheme"), QLatin1String("Linux")).toString();
-
-    highlightCurrentTerminal = m_settings->value(QLatin1String("highlightCurrentTerminal"), true).toBool();
-    focusOnMoueOver = m_settings->value(QLatin1String("focusOnMoueOver"), false).toBool();
-    showTerminalSizeHint = m_settings->value(QLatin1String("showTerminalSizeHint"), true).toBool();
-
-    font = QFont(qvariant_cast<QString>(m_settings->value(QLatin1String("fontFamily"), defaultFont().family())),
-                 qvariant_cast<int>(m_settings->value(QLatin1String("fontSize"), defaultFont().pointSize())));
-    //Legacy font setting
-    font = qvariant_cast<QFont>(m_settings->value(QLatin1String("font"), font));
-
-    mainWindowSize = m_settings->value(QLatin1String("MainWindow/size")).toSize();
-    fixedWindowSize = m_settings->value(QLatin1String("MainWindow/fixedSize"), QSize(600, 400)).toSize().expandedTo(QSize(300, 200));
-    mainWindowPosition = m_settings->value(QLatin1String("MainWindow/pos")).toPoint();
-    mainWindowState = m_settings->value(QLatin1String("MainWindow/state")).toByteArray();
-
-    historyLimited = m_settings->value(QLatin1String("HistoryLimited"), true).toBool();
-    historyLimitedTo = m_settings->value(QLatin1String("HistoryLimitedTo"), 1000).toUInt();
-
-    emulation = m_settings->value(QLatin1String("emulation"), QLatin1String("default")).toString();
+    m_changedKeys.clear();
+    readSettings([this](const QString &key, const QVariant &defaultValue) {
+        return m_settings->value(key, defaultValue);
+    });
 
     // sessions
     int size = m_settings->beginReadArray(QLatin1String("Sessions"));
@@ -114,50 +112,95 @@ void Properties::loadSettings()
     }
     m_settings->endArray();
 
-    terminalMargin = m_settings->value(QLatin1String("TerminalMargin"), 0).toInt();
+    // remember what the file contains, so that only changes are written
+    m_shortcuts.clear();
+    m_written.clear();
+    const QVariantMap values = settingsValues();
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+    {
+        if (m_settings->contains(it.key()))
+            m_written[it.key()] = it.value();
+    }
+    m_fingerprint = fileFingerprint();
+}
+
+void Properties::readSettings(const SettingsGetter &value)
+{
+    ++m_generation;
+
+    const QString oldStyle = guiStyle;
+    guiStyle = value(QLatin1String("guiStyle"), QString()).toString();
+    if (!guiStyle.isNull() && guiStyle != oldStyle)
+        QApplication::setStyle(guiStyle);
+
+    colorScheme = value(QLatin1String("colorScheme"), QLatin1String("Linux")).toString();
+
+    highlightCurrentTerminal = value(QLatin1String("highlightCurrentTerminal"), true).toBool();
+    focusOnMoueOver = value(QLatin1String("focusOnMoueOver"), false).toBool();
+    showTerminalSizeHint = value(QLatin1String("showTerminalSizeHint"), true).toBool();
+
+    font = QFont(qvariant_cast<QString>(value(QLatin1String("fontFamily"), defaultFont().family())),
+                 qvariant_cast<int>(value(QLatin1String("fontSize"), defaultFont().pointSize())));
+    //Legacy font setting
+    font = qvariant_cast<QFont>(value(QLatin1String("font"), font));
+
+    mainWindowSize = value(QLatin1String("MainWindow/size"), QVariant()).toSize();
+    fixedWindowSize = value(QLatin1String("MainWindow/fixedSize"), QSize(600, 400)).toSize().expandedTo(QSize(300, 200));
+    mainWindowPosition = value(QLatin1String("MainWindow/pos"), QVariant()).toPoint();
+    mainWindowState = value(QLatin1String("MainWindow/state"), QVariant()).toByteArray();
+
+    historyLimited = value(QLatin1String("HistoryLimited"), true).toBool();
+    historyLimitedTo = value(QLatin1String("HistoryLimitedTo"), 1000).toUInt();
+
+    emulation = value(QLatin1String("emulation"), QLatin1String("default")).toString();
 
-    termTransparency = m_settings->value(QLatin1String("TerminalTransparency"), 0).toInt();
-    backgroundImage = m_settings->value(QLatin1String("TerminalBackgroundImage"), QString()).toString();
-    backgroundMode = qBound(0, m_settings->value(QLatin1String("TerminalBackgroundMode"), 0).toInt(), 5);
+    terminalMargin = value(QLatin1String("TerminalMargin"), 0).toInt();
+
+    termTransparency = value(QLatin1String("TerminalTransparency"), 0).toInt();
+    backgroundImage = value(QLatin1String("TerminalBackgroundImage"), QString()).toString();
+    backgroundMode = qBound(0, value(QLatin1String("TerminalBackgroundMode"), 0).toInt(), 5);
 
     /* default to Right. see qtermwidget.h */
-    scrollBarPos = m_settings->value(QLatin1String("ScrollbarPosition"), 2).toInt();
+    scrollBarPos = value(QLatin1String("ScrollbarPosition"), 2).toInt();
     /* default to North. I'd prefer South but North is standard (they say) */
-    tabsPos = qBound(0, m_settings->value(QLatin1String("TabsPosition"), 0).toInt(), 3);
+    tabsPos = qBound(0, value(QLatin1String("TabsPosition"), 0).toInt(), 3);
     /* default to BlockCursor */
-    keyboardCursorShape = m_settings->value(QLatin1String("KeyboardCursorShape"), 0).toInt();
-    keyboardCursorBlink = m_settings->value(QLatin1String("KeyboardCursorBlink"), false).toBool();
-    hideTabBarWithOneTab = m_settings->value(QLatin1String("HideTabBarWithOneTab"), false).toBool();
+    keyboardCursorShape = value(QLatin1String("KeyboardCursorShape"), 0).toInt();
+    keyboardCursorBlink = value(QLatin1String("KeyboardCursorBlink"), false).toBool();
+    hideTabBarWithOneTab = value(QLatin1String("HideTabBarWithOneTab"), false).toBool();
     // For "Motion after paste", 2 (scrolling to bottom) makes more sense
-    m_motionAfterPaste = m_settings->value(QLatin1String("MotionAfterPaste"), 2).toInt();
-    m_disableBracketedPasteMode = m_settings->value(QLatin1String("DisableBracketedPasteMode"), false).toBool();
+    m_motionAfterPaste = value(QLatin1String("MotionAfterPaste"), 2).toInt();
+    m_disableBracketedPasteMode = value(QLatin1String("DisableBracketedPasteMode"), false).toBool();
 
     /* fixed tabs width */
-    fixedTabWidth = m_settings->value(QLatin1String("FixedTabWidth"), true).toBool();
-    fixedTabWidthValue = m_settings->value(QLatin1String("FixedTabWidthValue"), 500).toInt();
+    fixedTabWidth = value(QLatin1String("FixedTabWidth"), true).toBool();
+    fixedTabWidthValue = value(QLatin1String("FixedTabWidthValue"), 500).toInt();
     /* tabs features */
-    showCloseTabButton = m_settings->value(QLatin1String("ShowCloseTabButton"), true).toBool();
-    closeTabOnMiddleClick = m_settings->value(QLatin1String("CloseTabOnMiddleClick"), true).toBool();
+    showCloseTabButton = value(QLatin1String("ShowCloseTabButton"), true).toBool();
+    closeTabOnMiddleClick = value(QLatin1String("CloseTabOnMiddleClick"), true).toBool();
 
     /* toggles */
-    borderless = m_settings->value(QLatin1String("Borderless"), false).toBool();
-    tabBarless = m_settings->value(QLatin1String("TabBarless"), false).toBool();
-    menuVisible = m_settings->value(QLatin1String("MenuVisible"), true).toBool();
-    boldIntense = m_settings->value(QLatin1String("BoldIntense"), true).toBool();
-    noMenubarAccel = m_settings->value(QLatin1String("NoMenubarAccel"), true).toBool();
-    askOnExit = m_settings->value(QLatin1String("AskOnExit"), true).toBool();
-    saveSizeOnExit = m_settings->value(QLatin1String("SaveSizeOnExit"), true).toBool();
-    savePosOnExit = m_settings->value(QLatin1String("SavePosOnExit"), true).toBool();
-    saveStateOnExit = m_settings->value(QLatin1String("SaveStateOnExit"), true).toBool();
-    useCWD = m_settings->value(QLatin1String("UseCWD"), true).toBool();
-    m_openNewTabRightToActiveTab = m_settings->value(QLatin1String("OpenNewTabRightToActiveTab"), false).toBool();
-    audibleBell = m_settings->value(QLatin1String("AudibleBell"), false).toBool();
-    term = m_settings->value(QLatin1String("Term"), QLatin1String("xterm-256color")).toString();
-    handleHistoryCommand = m_settings->value(QLatin1String("HandleHistory")).toString();
+    borderless = value(QLatin1String("Borderless"), false).toBool();
+    tabBarless = value(QLatin1String("TabBarless"), false).toBool();
+    menuVisible = value(QLatin1String("MenuVisible"), true).toBool();
+    boldIntense = value(QLatin1String("BoldIntense"), true).toBool();
+    noMenubarAccel = value(QLatin1String("NoMenubarAccel"), true).toBool();
+    askOnExit = value(QLatin1String("AskOnExit"), true).toBool();
+    saveSizeOnExit = value(QLatin1String("SaveSizeOnExit"), true).toBool();
+    savePosOnExit = value(QLatin1String("SavePosOnExit"), true).toBool();
+    saveStateOnExit = value(QLatin1String("SaveStateOnExit"), true).toBool();
+    useCWD = value(QLatin1String("UseCWD"), true).toBool();
+    m_openNewTabRightToActiveTab = value(QLatin1String("OpenNewTabRightToActiveTab"), false).toBool();
+    startTabsEagerly = value(QLatin1String("StartTabsEagerly"), false).toBool();
+    audibleBell = value(QLatin1String("AudibleBell"), false).toBool();
+    controlSocket = value(QLatin1String("ControlSocket"), false).toBool();
+    term = value(QLatin1String("Term"), QLatin1String("xterm-256color")).toString();
+    handleHistoryCommand = value(QLatin1String("HandleHistory"), QVariant()).toString();
+    hibernateAfter = value(QLatin1String("HibernateAfter"), 0).toInt();
 
     // bookmarks
-    useBookmarks = m_settings->value(QLatin1String("UseBookmarks"), false).toBool();
-    bookmarksVisible = m_settings->value(QLatin1String("BookmarksVisible"), true).toBool();
+    useBookmarks = value(QLatin1String("UseBookmarks"), false).toBool();
+    bookmarksVisible = value(QLatin1String("BookmarksVisible"), true).toBool();
     QString s;
     QFileInfo fInfo(m_settings->fileName());
     if (fInfo.exists())
@@ -168,33 +211,31 @@ void Properties::loadSettings()
     { // fInfo.canonicalPath() gives "."
         s = m_settings->fileName().section(QLatin1String("/"), 0, -2) + QString::fromLatin1("/qterminal_bookmarks.xml");
     }
-    bookmarksFile = m_settings->value(QLatin1String("BookmarksFile"), s).toString();
+    bookmarksFile = value(QLatin1String("BookmarksFile"), s).toString();
 
-    terminalsPreset = m_settings->value(QLatin1String("TerminalsPreset"), 0).toInt();
+    terminalsPreset = value(QLatin1String("TerminalsPreset"), 0).toInt();
 
-    m_settings->beginGroup(QLatin1String("DropMode"));
-    dropShortCut = QKeySequence(m_settings->value(QLatin1String("ShortCut"), QLatin1String("F12")).toString());
-    dropLockShortCut = QKeySequence(m_settings->value(QLatin1String("KeepOpenShortCut")).toString());
-    dropKeepOpen = m_settings->value(QLatin1String("KeepOpen"), false).toBool();
-    dropShowOnStart = m_settings->value(QLatin1String("ShowOnStart"), true).toBool();
-    dropWidth = qBound(25, m_settings->value(QLatin1String("Width"), 70).toInt(), 100);
-    dropHeight = qBound(25, m_settings->value(QLatin1String("Height"), 45).toInt(), 100);
-    m_settings->endGroup();
+    dropShortCut = QKeySequence(value(QLatin1String("DropMode/ShortCut"), QLatin1String("F12")).toString());
+    dropLockShortCut = QKeySequence(value(QLatin1String("DropMode/KeepOpenShortCut"), QVariant()).toString());
+    dropKeepOpen = value(QLatin1String("DropMode/KeepOpen"), false).toBool();
+    dropShowOnStart = value(QLatin1String("DropMode/ShowOnStart"), true).toBool();
+    dropWidth = qBound(25, value(QLatin1String("DropMode/Width"), 70).toInt(), 100);
+    dropHeight = qBound(25, value(QLatin1String("DropMode/Height"), 45).toInt(), 100);
 
-    changeWindowTitle = m_settings->value(QLatin1String("ChangeWindowTitle"), true).toBool();
-    changeWindowIcon = m_settings->value(QLatin1String("ChangeWindowIcon"), true).toBool();
-    enabledBidiSupport = m_settings->value(QLatin1String("enabledBidiSupport"), true).toBool();
-    useFontBoxDrawingChars = m_settings->value(QLatin1String("UseFontBoxDrawingChars"), false).toBool();
+    changeWindowTitle = value(QLatin1String("ChangeWindowTitle"), true).toBool();
+    changeWindowIcon = value(QLatin1String("ChangeWindowIcon"), true).toBool();
+    enabledBidiSupport = value(QLatin1String("enabledBidiSupport"), true).toBool();
+    useFontBoxDrawingChars = value(QLatin1String("UseFontBoxDrawingChars"), false).toBool();
 
-    confirmMultilinePaste = m_settings->value(QLatin1String("ConfirmMultilinePaste"), false).toBool();
-    trimPastedTrailingNewlines = m_settings->value(QLatin1String("TrimPastedTrailingNewlines"), false).toBool();
-    wordCharacters = m_settings->value(QLatin1String("WordCharacters"), QLatin1String(":@-./_~")).toString();
+    confirmMultilinePaste = value(QLatin1String("ConfirmMultilinePaste"), false).toBool();
+    trimPastedTrailingNewlines = value(QLatin1String("TrimPastedTrailingNewlines"), false).toBool();
+    wordCharacters = value(QLatin1String("WordCharacters"), QLatin1String(":@-./_~")).toString();
 
-    windowMaximized = m_settings->value(QLatin1String("LastWindowMaximized"), false).toBool();
+    windowMaximized = value(QLatin1String("LastWindowMaximized"), false).toBool();
 
-    swapMouseButtons2and3 = m_settings->value(QLatin1String("SwapMouseButtons2and3"), false).toBool();
+    swapMouseButtons2and3 = value(QLatin1String("SwapMouseButtons2and3"), false).toBool();
 
-    mouseAutoHideDelay = m_settings->value(QLatin1String("MouseAutoHideDelay"), -1).toInt();
+    mouseAutoHideDelay = value(QLatin1String("MouseAutoHideDelay"), -1).toInt();
     if (mouseAutoHideDelay > 0)
     {
         mouseAutoHideDelay *= 1000;
@@ -204,120 +245,103 @@ void Properties::loadSettings()
         mouseAutoHideDelay = -1; // disable (no zero delay)
     }
 
-    prefDialogSize = m_settings->value(QLatin1String("PrefDialogSize")).toSize();
+    prefDialogSize = value(QLatin1String("PrefDialogSize"), QVariant()).toSize();
 }
 
-void Properties::saveSettings()
+QVariantMap Properties::settingsValues() const
 {
-    m_settings->setValue(QLatin1String("guiStyle"), guiStyle);
-    m_settings->setValue(QLatin1String("colorScheme"), colorScheme);
-    m_settings->setValue(QLatin1String("highlightCurrentTerminal"), highlightCurrentTerminal);
-    m_settings->setValue(QLatin1String("focusOnMoueOver"), focusOnMoueOver);
-    m_settings->setValue(QLatin1String("showTerminalSizeHint"), showTerminalSizeHint);
-    m_settings->setValue(QLatin1String("fontFamily"), font.family());
-    m_settings->setValue(QLatin1String("fontSize"), font.pointSize());
-    //Clobber legacy setting
-    m_settings->remove(QLatin1String("font"));
+    QVariantMap values;
+    values[QLatin1String("guiStyle")] = guiStyle;
+    values[QLatin1String("colorScheme")] = colorScheme;
+    values[QLatin1String("highlightCurrentTerminal")] = highlightCurrentTerminal;
+    values[QLatin1String("focusOnMoueOver")] = focusOnMoueOver;
+    values[QLatin1String("showTerminalSizeHint")] = showTerminalSizeHint;
+    values[QLatin1String("fontFamily")] = font.family();
+    values[QLatin1String("fontSize")] = font.pointSize();
 
-    m_settings->beginGroup(QLatin1String("Shortcuts"));
-    MainWindow *mainWindow = QTerminalApp::Instance()->getWindowList()[0];
-    assert(mainWindow != nullptr);
+    for (auto it = m_shortcuts.cbegin(); it != m_shortcuts.cend(); ++it)
+        values[QLatin1String("Shortcuts/") + it.key()] = it.value();
 
-    QMapIterator< QString, QAction * > it(mainWindow->leaseActions());
-    while( it.hasNext() )
-    {
-        it.next();
-        QStringList sequenceStrings;
-        const auto shortcuts = it.value()->shortcuts();
-        for (const QKeySequence &shortcut : shortcuts)
-            sequenceStrings.append(shortcut.toString());
-        m_settings->setValue(it.key(), sequenceStrings.join(QLatin1Char('|')));
-    }
-    m_settings->endGroup();
-
-    m_settings->setValue(QLatin1String("MainWindow/size"), mainWindowSize);
-    m_settings->setValue(QLatin1String("MainWindow/fixedSize"), fixedWindowSize);
-    m_settings->setValue(QLatin1String("MainWindow/pos"), mainWindowPosition);
-    m_settings->setValue(QLatin1String("MainWindow/state"), mainWindowState);
+    values[QLatin1String("MainWindow/size")] = mainWindowSize;
+    values[QLatin1String("MainWindow/fixedSize")] = fixedWindowSize;
+    values[QLatin1String("MainWindow/pos")] = mainWindowPosition;
+    values[QLatin1String("MainWindow/state")] = mainWindowState;
 
-    m_settings->setValue(QLatin1String("HistoryLimited"), historyLimited);
-    m_settings->setValue(QLatin1String("HistoryLimitedTo"), historyLimitedTo);
+    values[QLatin1String("HistoryLimited")] = historyLimited;
+    values[QLatin1String("HistoryLimitedTo")] = historyLimitedTo;
 
-    m_settings->setValue(QLatin1String("emulation"), emulation);
+    values[QLatin1String("emulation")] = emulation;
 
-    // sessions
-    m_settings->beginWriteArray(QLatin1String("Sessions"));
+    // sessions, in the layout of QSettings::beginWriteArray()
     int i = 0;
-    Sessions::iterator sit = sessions.begin();
-    while (sit != sessions.end())
+    for (auto sit = sessions.cbegin(); sit != sessions.cend(); ++sit)
     {
-        m_settings->setArrayIndex(i);
-        m_settings->setValue(QLatin1String("name"), sit.key());
-        m_settings->setValue(QLatin1String("state"), sit.value());
-        ++sit;
         ++i;
+        values[QStringLiteral("Sessions/%1/name").arg(i)] = sit.key();
+        values[QStringLiteral("Sessions/%1/state").arg(i)] = sit.value();
     }
-    m_settings->endArray();
-
-    m_settings->setValue(QLatin1String("TerminalMargin"), terminalMargin);
-    m_settings->setValue(QLatin1String("TerminalTransparency"), termTransparency);
-    m_settings->setValue(QLatin1String("TerminalBackgroundImage"), backgroundImage);
-    m_settings->setValue(QLatin1String("TerminalBackgroundMode"), backgroundMode);
-    m_settings->setValue(QLatin1String("ScrollbarPosition"), scrollBarPos);
-    m_settings->setValue(QLatin1String("TabsPosition"), tabsPos);
-    m_settings->setValue(QLatin1String("KeyboardCursorShape"), keyboardCursorShape);
-    m_settings->setValue(QLatin1String("KeyboardCursorBlink"), keyboardCursorBlink);
-    m_settings->setValue(QLatin1String("HideTabBarWithOneTab"), hideTabBarWithOneTab);
-    m_settings->setValue(QLatin1String("MotionAfterPaste"), m_motionAfterPaste);
-    m_settings->setValue(QLatin1String("DisableBracketedPasteMode"), m_disableBracketedPasteMode);
-
-    m_settings->setValue(QLatin1String("FixedTabWidth"), fixedTabWidth);
-    m_settings->setValue(QLatin1String("FixedTabWidthValue"), fixedTabWidthValue);
-    m_settings->setValue(QLatin1String("ShowCloseTabButton"), showCloseTabButton);
-    m_settings->setValue(QLatin1String("CloseTabOnMiddleClick"), closeTabOnMiddleClick);
-
-    m_settings->setValue(QLatin1String("Borderless"), borderless);
-    m_settings->setValue(QLatin1String("TabBarless"), tabBarless);
-    m_settings->setValue(QLatin1String("BoldIntense"), boldIntense);
-    m_settings->setValue(QLatin1String("NoMenubarAccel"), noMenubarAccel);
-    m_settings->setValue(QLatin1String("MenuVisible"), menuVisible);
-    m_settings->setValue(QLatin1String("AskOnExit"), askOnExit);
-    m_settings->setValue(QLatin1String("SavePosOnExit"), savePosOnExit);
-    m_settings->setValue(QLatin1String("SaveSizeOnExit"), saveSizeOnExit);
-    m_settings->setValue(QLatin1String("SaveStateOnExit"), saveStateOnExit);
-    m_settings->setValue(QLatin1String("UseCWD"), useCWD);
-    m_settings->setValue(QLatin1String("OpenNewTabRightToActiveTab"), m_openNewTabRightToActiveTab);
-    m_settings->setValue(QLatin1String("AudibleBell"), audibleBell);
-    m_settings->setValue(QLatin1String("Term"), term);
-    m_settings->setValue(QLatin1String("HandleHistory"), handleHistoryCommand);
+    values[QStringLiteral("Sessions/size")] = i;
+
+    values[QLatin1String("TerminalMargin")] = terminalMargin;
+    values[QLatin1String("TerminalTransparency")] = termTransparency;
+    values[QLatin1String("TerminalBackgroundImage")] = backgroundImage;
+    values[QLatin1String("TerminalBackgroundMode")] = backgroundMode;
+    values[QLatin1String("ScrollbarPosition")] = scrollBarPos;
+    values[QLatin1String("TabsPosition")] = tabsPos;
+    values[QLatin1String("KeyboardCursorShape")] = keyboardCursorShape;
+    values[QLatin1String("KeyboardCursorBlink")] = keyboardCursorBlink;
+    values[QLatin1String("HideTabBarWithOneTab")] = hideTabBarWithOneTab;
+    values[QLatin1String("MotionAfterPaste")] = m_motionAfterPaste;
+    values[QLatin1String("DisableBracketedPasteMode")] = m_disableBracketedPasteMode;
+
+    values[QLatin1String("FixedTabWidth")] = fixedTabWidth;
+    values[QLatin1String("FixedTabWidthValue")] = fixedTabWidthValue;
+    values[QLatin1String("ShowCloseTabButton")] = showCloseTabButton;
+    values[QLatin1String("CloseTabOnMiddleClick")] = closeTabOnMiddleClick;
+
+    values[QLatin1String("Borderless")] = borderless;
+    values[QLatin1String("TabBarless")] = tabBarless;
+    values[QLatin1String("BoldIntense")] = boldIntense;
+    values[QLatin1String("NoMenubarAccel")] = noMenubarAccel;
+    values[QLatin1String("MenuVisible")] = menuVisible;
+    values[QLatin1String("AskOnExit")] = askOnExit;
+    values[QLatin1String("SavePosOnExit")] = savePosOnExit;
+    values[QLatin1String("SaveSizeOnExit")] = saveSizeOnExit;
+    values[QLatin1String("SaveStateOnExit")] = saveStateOnExit;
+    values[QLatin1String("UseCWD")] = useCWD;
+    values[QLatin1String("OpenNewTabRightToActiveTab")] = m_openNewTabRightToActiveTab;
+    values[QLatin1String("StartTabsEagerly")] = startTabsEagerly;
+    values[QLatin1String("AudibleBell")] = audibleBell;
+    values[QLatin1String("ControlSocket")] = controlSocket;
+    values[QLatin1String("Term")] = term;
+    values[QLatin1String("HandleHistory")] = handleHistoryCommand;
+    values[QLatin1String("HibernateAfter")] = hibernateAfter;
 
     // bookmarks
-    m_settings->setValue(QLatin1String("UseBookmarks"), useBookmarks);
-    m_settings->setValue(QLatin1String("BookmarksVisible"), bookmarksVisible);
-    m_settings->setValue(QLatin1String("BookmarksFile"), bookmarksFile);
-
-    m_settings->setValue(QLatin1String("TerminalsPreset"), terminalsPreset);
-
-    m_settings->beginGroup(QLatin1String("DropMode"));
-    m_settings->setValue(QLatin1String("ShortCut"), dropShortCut.toString());
-    m_settings->setValue(QLatin1String("KeepOpenShortCut"), dropLockShortCut.toString());
-    m_settings->setValue(QLatin1String("KeepOpen"), dropKeepOpen);
-    m_settings->setValue(QLatin1String("ShowOnStart"), dropShowOnStart);
-    m_settings->setValue(QLatin1String("Width"), dropWidth);
-    m_settings->setValue(QLatin1String("Height"), dropHeight);
-    m_settings->endGroup();
+    values[QLatin1String("UseBookmarks")] = useBookmarks;
+    values[QLatin1String("BookmarksVisible")] = bookmarksVisible;
+    values[QLatin1String("BookmarksFile")] = bookmarksFile;
+
+    values[QLatin1String("TerminalsPreset")] = terminalsPreset;
+
+    values[QStringLiteral("DropMode/ShortCut")] = dropShortCut.toString();
+    values[QStringLiteral("DropMode/KeepOpenShortCut")] = dropLockShortCut.toString();
+    values[QStringLiteral("DropMode/KeepOpen")] = dropKeepOpen;
+    values[QStringLiteral("DropMode/ShowOnStart")] = dropShowOnStart;
+    values[QStringLiteral("DropMode/Width")] = dropWidth;
+    values[QStringLiteral("DropMode/Height")] = dropHeight;
 
-    m_settings->setValue(QLatin1String("ChangeWindowTitle"), changeWindowTitle);
-    m_settings->setValue(QLatin1String("ChangeWindowIcon"), changeWindowIcon);
-    m_settings->setValue(QLatin1String("enabledBidiSupport"), enabledBidiSupport);
-    m_settings->setValue(QLatin1String("UseFontBoxDrawingChars"), useFontBoxDrawingChars);
+    values[QLatin1String("ChangeWindowTitle")] = changeWindowTitle;
+    values[QLatin1String("ChangeWindowIcon")] = changeWindowIcon;
+    values[QLatin1String("enabledBidiSupport")] = enabledBidiSupport;
+    values[QLatin1String("UseFontBoxDrawingChars")] = useFontBoxDrawingChars;
 
-    m_settings->setValue(QLatin1String("ConfirmMultilinePaste"), confirmMultilinePaste);
-    m_settings->setValue(QLatin1String("TrimPastedTrailingNewlines"), trimPastedTrailingNewlines);
-    m_settings->setValue(QLatin1String("WordCharacters"), wordCharacters);
+    values[QLatin1String("ConfirmMultilinePaste")] = confirmMultilinePaste;
+    values[QLatin1String("TrimPastedTrailingNewlines")] = trimPastedTrailingNewlines;
+    values[QLatin1String("WordCharacters")] = wordCharacters;
 
-    m_settings->setValue(QLatin1String("LastWindowMaximized"), windowMaximized);
-    m_settings->setValue(QLatin1String("SwapMouseButtons2and3"), swapMouseButtons2and3);
+    values[QLatin1String("LastWindowMaximized")] = windowMaximized;
+    values[QLatin1String("SwapMouseButtons2and3")] = swapMouseButtons2and3;
 
     int autoDelay = mouseAutoHideDelay;
     if (autoDelay > 0)
@@ -328,16 +352,171 @@ void Properties::saveSettings()
     {
         autoDelay = 0; // means disabling when saved
     }
-    m_settings->setValue(QLatin1String("MouseAutoHideDelay"), autoDelay);
+    values[QLatin1String("MouseAutoHideDelay")] = autoDelay;
+
+    values[QLatin1String("PrefDialogSize")] = prefDialogSize;
+
+    return values;
+}
 
-    m_settings->setValue(QLatin1String("PrefDialogSize"), prefDialogSize);
+void Properties::saveSettings()
+{
+    // the members may have been changed directly, so anything cached from them is stale
+    ++m_generation;
+    m_changedKeys.clear();
+
+    // several changes in a row are written at once
+    m_saveTimer->start();
+}
+
+void Properties::setShortcut(const QString &name, const QString &sequence)
+{
+    m_shortcuts[name] = sequence;
+}
+
+void Properties::flushSettings()
+{
+    m_saveTimer->stop();
+
+    bool changed = false;
+    QSet<QString> dirty;
+    const QVariantMap values = settingsValues();
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+    {
+        auto written = m_written.constFind(it.key());
+        if (written == m_written.cend() || written.value() != it.value())
+        {
+            m_settings->setValue(it.key(), it.value());
+            m_written[it.key()] = it.value();
+            dirty.insert(it.key());
+            changed = true;
+        }
+    }
+    //Clobber legacy setting
+    if (m_settings->contains(QLatin1String("font")))
+    {
+        m_settings->remove(QLatin1String("font"));
+        changed = true;
+    }
+    if (!changed)
+        return;
+
+    m_settings->sync();
+    // our own write should not be taken for a change by another process
+    m_fingerprint = fileFingerprint();
+
+#ifdef HAVE_QDBUS
+    // let other instances using the same file apply the changes without re-reading it
+    QVariantMap changes;
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+    {
+        if (!dirty.contains(it.key()) || it.key().startsWith(QLatin1String("MainWindow/")))
+            continue;
+        switch (it.value().typeId())
+        {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::QString:
+            changes[it.key()] = it.value();
+            break;
+        default: // geometry and other window state
+            break;
+        }
+    }
+    if (!changes.isEmpty())
+    {
+        QDBusMessage msg = QDBusMessage::createSignal(QStringLiteral("/settings"),
+                                                      QStringLiteral("org.lxqt.QTerminal.Settings"),
+                                                      QStringLiteral("settingsChanged"));
+        msg << m_settings->fileName() << changes;
+        QDBusConnection::sessionBus().send(msg);
+    }
+#endif
 
     // the config file may be created now
     if (!m_watcher->files().contains(m_settings->fileName()))
-    {
-        m_settings->sync();
         m_watcher->addPath(m_settings->fileName());
+}
+
+bool Properties::applyChanges(const QString &file, const QVariantMap &changes)
+{
+    if (file != m_settings->fileName())
+        return false;
+
+    m_changedKeys.clear();
+    for (auto it = changes.cbegin(); it != changes.cend(); ++it)
+    {
+        // our own broadcast comes back too
+        if (m_written.value(it.key()) != it.value())
+            m_changedKeys.insert(it.key());
     }
+    if (m_changedKeys.isEmpty())
+        return false;
+
+    // keep pending changes of our own
+    if (m_saveTimer->isActive())
+        flushSettings();
+
+    readSettings([this, &changes](const QString &key, const QVariant &defaultValue) {
+        auto it = changes.constFind(key);
+        return it != changes.cend() ? it.value() : m_settings->value(key, defaultValue);
+    });
+    for (const QString &key : std::as_const(m_changedKeys))
+    {
+        m_written[key] = changes.value(key);
+        if (key.startsWith(QLatin1String("Shortcuts/")))
+            m_shortcuts[key.mid(10)] = changes.value(key).toString();
+    }
+    // the file has been written by the sender; do not parse it again
+    m_fingerprint = fileFingerprint();
+    return true;
+}
+
+bool Properties::isChanged(const QString &key) const
+{
+    return m_changedKeys.isEmpty() || m_changedKeys.contains(key);
+}
+
+bool Properties::isGroupChanged(const QString &group) const
+{
+    if (m_changedKeys.isEmpty())
+        return true;
+    for (const QString &key : m_changedKeys)
+    {
+        if (key.startsWith(group))
+            return true;
+    }
+    return false;
+}
+
+void Properties::clearChanges()
+{
+    m_changedKeys.clear();
+}
+
+QPair<qint64, qint64> Properties::fileFingerprint() const
+{
+    QFileInfo info(m_settings->fileName());
+    if (!info.exists())
+        return {-1, -1};
+    return {info.lastModified().toMSecsSinceEpoch(), info.size()};
+}
+
+void Properties::fileChanged()
+{
+    const QString path = m_settings->fileName();
+    if (!m_watcher->files().contains(path) && QFile::exists(path))
+        m_watcher->addPath(path); // the file is replaced on every write
+
+    if (fileFingerprint() == m_fingerprint)
+        return;
+
+    // keep pending changes of our own; QSettings merges them with the file
+    if (m_saveTimer->isActive())
+        flushSettings();
+    m_settings->sync();
+    loadSettings();
 }
 
 int Properties::versionComparison(const QString &v1, const QString &v2)
@@ -436,12 +615,34 @@ void Properties::removeAccelerator(QString& str)
 
 QString Properties::getShortcut(const QString &name, const QString &defaultShortcut) const
 {
+    // not written yet
+    auto it = m_shortcuts.constFind(name);
+    if (it != m_shortcuts.cend())
+        return it.value();
+
     m_settings->beginGroup(QStringLiteral("Shortcuts"));
     QString sequence = m_settings->value(name, defaultShortcut).toString();
     m_settings->endGroup();
     return sequence;
 }
 
+ShortcutMap Properties::getShortcuts(const ShortcutMap &defaults) const
+{
+    ShortcutMap sequences;
+    m_settings->beginGroup(QStringLiteral("Shortcuts"));
+    for (auto it = defaults.cbegin(); it != defaults.cend(); ++it)
+    {
+        // not written yet
+        auto written = m_shortcuts.constFind(it.key());
+        if (written != m_shortcuts.cend())
+            sequences[it.key()] = written.value();
+        else
+            sequences[it.key()] = m_settings->value(it.key(), it.value()).toString();
+    }
+    m_settings->endGroup();
+    return sequences;
+}
+
 QString Properties::configDir() const
 {
     return QFileInfo(m_settings->fileName()).absoluteDir().canonicalPath();
@@ -22,9 +22,12 @@
 #include <QApplication>
 #include <QtCore>
 #include <QFont>
+#include <QKeySequence>
 #include <QFileSystemWatcher>
 #include <QString>
 
+#include <functional>
+
 typedef QString Session;
 
 typedef QMap<QString,Session> Sessions;
@@ -39,10 +42,28 @@ class Properties
         ~Properties();
 
         QFont defaultFont();
+        // schedules writing the changed settings; call it after changing any of the members
         void saveSettings();
+        // writes the changed settings now
+        void flushSettings();
         void loadSettings();
         void migrate_settings();
+
+        // applies settings changed by another instance; returns false if nothing changed
+        bool applyChanges(const QString &file, const QVariantMap &changes);
+        // whether a key was changed by applyChanges(); always true after a full load
+        bool isChanged(const QString &key) const;
+        // the same for any key in group, e.g. "Shortcuts/"
+        bool isGroupChanged(const QString &group) const;
+        void clearChanges();
+        // incremented whenever the settings are read
+        quint64 generation() const { return m_generation; }
+
         QString getShortcut(const QString &name, const QString &defaultShortcut) const;
+        // getShortcut() for all keys of defaults at once
+        ShortcutMap getShortcuts(const ShortcutMap &defaults) const;
+        // "|" separated key sequences in portable text, written by the next saveSettings()
+        void setShortcut(const QString &name, const QString &sequence);
         QString configDir() const;
         QString profile() const;
 
@@ -103,12 +124,19 @@ class Properties
 
         bool useCWD;
         bool m_openNewTabRightToActiveTab;
+        // create the terminals of tabs before they are shown
+        bool startTabsEagerly;
 
         bool audibleBell;
 
+        // remote control over a local socket, see ControlServer
+        bool controlSocket;
+
         QString term;
 
         QString handleHistoryCommand;
+        // minutes after which idle terminals move their history to disk, 0 for never
+        int hibernateAfter;
 
         bool useBookmarks;
         bool bookmarksVisible;
@@ -149,9 +177,27 @@ class Properties
 
         explicit Properties(const QString& filename);
 
+        typedef std::function<QVariant(const QString &key, const QVariant &defaultValue)> SettingsGetter;
+        void readSettings(const SettingsGetter &value);
+        QVariantMap settingsValues() const;
+        QPair<qint64, qint64> fileFingerprint() const;
+        void fileChanged();
+
         QSettings *m_settings;
 
         QFileSystemWatcher *m_watcher;
+
+        QTimer *m_saveTimer;
+        QTimer *m_reloadTimer;
+        // the settings as they are in the file
+        QVariantMap m_written;
+        // modification time and size of the file after our last read or write
+        QPair<qint64, qint64> m_fingerprint;
+        // shortcuts of the first window, captured by saveSettings()
+        ShortcutMap m_shortcuts;
+        // keys changed by the last applyChanges()
+        QSet<QString> m_changedKeys;
+        quint64 m_generation = 0;
 };
 
 #endif
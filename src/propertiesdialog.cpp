@@ -251,6 +251,7 @@ PropertiesDialog::PropertiesDialog(QWidget *parent)
 
     useCwdCheckBox->setChecked(Properties::Instance()->useCWD);
     openNewTabRightToActiveTabCheckBox->setChecked(Properties::Instance()->m_openNewTabRightToActiveTab);
+    startTabsEagerlyCheckBox->setChecked(Properties::Instance()->startTabsEagerly);
 
 #ifdef HAVE_LIBCANBERRA
     audibleBellCheckBox->setChecked(Properties::Instance()->audibleBell);
@@ -261,6 +262,7 @@ PropertiesDialog::PropertiesDialog(QWidget *parent)
     termComboBox->setCurrentText(Properties::Instance()->term);
 
     handleHistoryLineEdit->setText(Properties::Instance()->handleHistoryCommand);
+    hibernateSpinBox->setValue(Properties::Instance()->hibernateAfter);
 
     historyLimited->setChecked(Properties::Instance()->historyLimited);
     historyUnlimited->setChecked(!Properties::Instance()->historyLimited);
@@ -367,6 +369,7 @@ void PropertiesDialog::apply()
 
     Properties::Instance()->useCWD = useCwdCheckBox->isChecked();
     Properties::Instance()->m_openNewTabRightToActiveTab = openNewTabRightToActiveTabCheckBox->isChecked();
+    Properties::Instance()->startTabsEagerly = startTabsEagerlyCheckBox->isChecked();
 #ifdef HAVE_LIBCANBERRA
     Properties::Instance()->audibleBell = audibleBellCheckBox->isChecked();
 #else
@@ -375,6 +378,7 @@ void PropertiesDialog::apply()
 
     Properties::Instance()->term = termComboBox->currentText();
     Properties::Instance()->handleHistoryCommand = handleHistoryLineEdit->text();
+    Properties::Instance()->hibernateAfter = hibernateSpinBox->value();
 
     Properties::Instance()->scrollBarPos = scrollBarPos_comboBox->currentIndex();
     Properties::Instance()->tabsPos = tabsPos_comboBox->currentIndex();
@@ -492,10 +496,15 @@ void PropertiesDialog::applyShortcuts()
             continue;
 
         QList<QKeySequence> shortcuts;
+        QStringList portable;
         const auto sequences = item->text().split(QLatin1Char('|'));
         for (const QString& sequenceString : sequences)
+        {
             shortcuts.append(QKeySequence(sequenceString, QKeySequence::NativeText));
+            portable.append(shortcuts.constLast().toString());
+        }
         keyAction->setShortcuts(shortcuts);
+        Properties::Instance()->setShortcut(keyValue, portable.join(QLatin1Char('|')));
     }
 }
 
@@ -507,7 +516,7 @@ void PropertiesDialog::setupShortcuts()
         return;
     }
     // shortcuts may have changed by another running instance
-    winList.at(0)->rebuildActions();
+    winList.at(0)->updateActions();
 
     shortcutsWidget->setSortingEnabled(false);
 
@@ -0,0 +1,168 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <qtermwidget6/qtermwidget.h>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "ptywriter.h"
+
+namespace {
+
+const int ChunkSize = 4096;
+// unread input in the pty above which the writer waits for the program
+const int PendingLimit = 1024;
+const int RetryInterval = 10;
+
+} // namespace
+
+PtyWriter::PtyWriter(QTermWidget *term, int fd, QObject *parent)
+    : QObject(parent)
+    , m_term(term)
+    , m_fd(fd)
+    , m_notifier(new QSocketNotifier(fd, QSocketNotifier::Read, this))
+    , m_timer(new QTimer(this))
+    // stateful, a chunk may end in the middle of a character
+    , m_decoder(QStringDecoder::Utf8)
+    , m_written(0)
+    , m_finished(false)
+{
+    ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+
+    m_notifier->setEnabled(false);
+    connect(m_notifier, &QSocketNotifier::activated, this, &PtyWriter::writeChunk);
+
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, [this] { m_notifier->setEnabled(true); });
+}
+
+PtyWriter::PtyWriter(QTermWidget *term, const QString &text, QObject *parent)
+    : QObject(parent)
+    , m_term(term)
+    , m_fd(-1)
+    , m_text(text)
+    , m_notifier(nullptr)
+    , m_timer(new QTimer(this))
+    , m_written(0)
+    , m_finished(false)
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &PtyWriter::writeChunk);
+}
+
+PtyWriter::~PtyWriter()
+{
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+void PtyWriter::start()
+{
+    if (m_finished)
+        return;
+    if (m_notifier)
+        m_notifier->setEnabled(true);
+    else
+        m_timer->start(0);
+}
+
+void PtyWriter::cancel()
+{
+    finish(false);
+}
+
+bool PtyWriter::inputPending() const
+{
+    const int slave = m_term->getPtySlaveFd();
+    int pending = 0;
+    return slave >= 0 && ::ioctl(slave, FIONREAD, &pending) == 0 && pending >= PendingLimit;
+}
+
+void PtyWriter::writeChunk()
+{
+    if (inputPending())
+    {
+        if (m_notifier)
+            m_notifier->setEnabled(false);
+        m_timer->start(RetryInterval);
+        return;
+    }
+
+    if (m_notifier)
+    {
+        readChunk();
+        return;
+    }
+
+    qsizetype length = qMin<qsizetype>(ChunkSize, m_text.size() - m_written);
+    // do not split a surrogate pair
+    if (length > 0 && m_written + length < m_text.size() && m_text.at(m_written + length - 1).isHighSurrogate())
+        --length;
+    m_term->sendText(m_text.mid(m_written, length));
+    m_written += length;
+    emit progress(m_written, m_text.size());
+    if (m_written >= m_text.size())
+        finish(true);
+    else
+        m_timer->start(0);
+}
+
+void PtyWriter::readChunk()
+{
+    char buffer[ChunkSize];
+    const ssize_t count = ::read(m_fd, buffer, sizeof(buffer));
+    if (count < 0)
+    {
+        if (errno != EAGAIN && errno != EINTR)
+            finish(false);
+        return;
+    }
+    if (count == 0)
+    {
+        finish(!m_decoder.hasError());
+        return;
+    }
+
+    const QString text = m_decoder.decode(QByteArrayView(buffer, count));
+    if (!text.isEmpty())
+        m_term->sendText(text);
+    m_written += count;
+    emit progress(m_written, -1);
+}
+
+void PtyWriter::finish(bool ok)
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+    m_timer->stop();
+    if (m_notifier)
+        m_notifier->setEnabled(false);
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    emit finished(ok);
+}
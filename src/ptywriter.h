@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef PTYWRITER_H
+#define PTYWRITER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringDecoder>
+
+class QSocketNotifier;
+class QTermWidget;
+class QTimer;
+
+/*! \brief Feeds input into a terminal without blocking the GUI.
+
+The input, read from a file descriptor or given as text, is sent in small
+chunks as the terminal's program consumes it: nothing more is sent while the
+pty still holds unread input, so a slow program throttles the writer instead of
+the data piling up in memory.
+*/
+class PtyWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    // takes ownership of fd
+    PtyWriter(QTermWidget *term, int fd, QObject *parent = nullptr);
+    PtyWriter(QTermWidget *term, const QString &text, QObject *parent = nullptr);
+    ~PtyWriter() override;
+
+    void start();
+    void cancel();
+    // bytes read from the fd, or characters of the text
+    qint64 written() const { return m_written; }
+    // -1 for a fd
+    qint64 total() const { return m_fd >= 0 || m_text.isNull() ? -1 : m_text.size(); }
+
+signals:
+    void progress(qint64 written, qint64 total);
+    void finished(bool ok);
+
+private:
+    void writeChunk();
+    void readChunk();
+    bool inputPending() const;
+    void finish(bool ok);
+
+    QTermWidget *m_term;
+    int m_fd;
+    QString m_text;
+    QSocketNotifier *m_notifier;
+    QTimer *m_timer;
+    QStringDecoder m_decoder;
+    qint64 m_written;
+    bool m_finished;
+};
+
+#endif
@@ -9,6 +9,8 @@
 
 #include "mainwindow.h"
 
+class ControlServer;
+class TerminalSelector;
 
 class QTerminalApp : public QApplication
 {
@@ -17,12 +19,24 @@ Q_OBJECT
 public:
     MainWindow *newWindow(bool dropMode, TerminalConfig &cfg, const QString &dbus_id = QString());
     QList<MainWindow*> getWindowList();
+    // the drop-down window, if this process has one
+    MainWindow *dropdownWindow() const;
     void addWindow(MainWindow *window);
     void removeWindow(MainWindow *window);
     static QTerminalApp *Instance(int &argc, char **argv);
     static QTerminalApp *Instance();
     QString &getWorkingDirectory();
     void setWorkingDirectory(const QString &wd);
+    QVariantMap getLayout();
+    // the terminals in all windows the selector matches, see TerminalSelector
+    QList<TermWidget*> matchingTerminals(const TerminalSelector &selector);
+    // runs action ("sendText", "close", "setLabel" or "closeTab") on the matching terminals;
+    // returns how many were acted on, or -1 if the selector or the action is invalid
+    int applyToTerminals(const QString &selector, const QString &action, const QString &argument);
+    // does nothing when built without BUILD_CONTROL_SOCKET
+    void startControlServer();
+    // empty when the control socket is not enabled
+    QString controlSocketPath() const;
 
     #ifdef HAVE_QDBUS
     void registerOnDbus(bool dropDown, const QString dbus_id);
@@ -39,11 +53,23 @@ public:
 
     static void cleanup();
 
+#ifdef HAVE_QDBUS
+signals:
+    void terminalAdded(const QDBusObjectPath &terminal);
+    void terminalRemoved(const QDBusObjectPath &terminal);
+
+private slots:
+    void applySettings(const QString &file, const QVariantMap &changes);
+#endif
+
 private:
     QString m_workDir;
     QList<MainWindow *> m_windowList;
     static QTerminalApp *m_instance;
     bool m_isPrimaryInstance = true;
+    // started with -d; the drop-down window is recreated on request after closing it
+    bool m_hostsDropdown = false;
+    ControlServer *m_controlServer = nullptr;
 #ifdef HAVE_QDBUS
     QString m_dbusService;
 #endif
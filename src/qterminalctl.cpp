@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+// Command line client for the control socket of qterminal, see controlserver.h
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+
+#include <cstdio>
+
+static void usage()
+{
+    fputs("Usage: qterminalctl [-s SOCKET] [METHOD [TARGET] [ARGS]]\n"
+          "\n"
+          "Sends METHOD with the JSON object ARGS to the object path TARGET and prints the result.\n"
+          "TARGET defaults to the terminal qterminalctl runs in. Without a METHOD, requests are\n"
+          "read from the standard input, one JSON object per line, and their replies are printed.\n"
+          "\n"
+          "SOCKET defaults to $QTERM_CONTROL_SOCKET, which is set in the terminals when the\n"
+          "control socket is enabled.\n", stderr);
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments().mid(1);
+
+    QString socketPath = qEnvironmentVariable("QTERM_CONTROL_SOCKET");
+    if (args.size() >= 2 && (args.at(0) == QLatin1String("-s") || args.at(0) == QLatin1String("--socket")))
+    {
+        socketPath = args.at(1);
+        args = args.mid(2);
+    }
+    if (!args.isEmpty() && (args.at(0) == QLatin1String("-h") || args.at(0) == QLatin1String("--help")))
+    {
+        usage();
+        return 0;
+    }
+    if (socketPath.isEmpty())
+    {
+        usage();
+        return 2;
+    }
+
+    QByteArray requests;
+    int count = 0;
+    if (!args.isEmpty())
+    {
+        QJsonObject request;
+        request[QLatin1String("id")] = 1;
+        request[QLatin1String("method")] = args.at(0);
+        QString target = qEnvironmentVariable("QTERM_CONTROL_OBJECT");
+        QString json;
+        if (args.size() > 1 && !args.at(1).startsWith(QLatin1Char('{')))
+        {
+            target = args.at(1);
+            json = args.value(2);
+        }
+        else
+        {
+            json = args.value(1);
+        }
+        request[QLatin1String("target")] = target;
+        if (!json.isEmpty())
+        {
+            const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
+            if (!doc.isObject())
+            {
+                fprintf(stderr, "ARGS is not a JSON object: %s\n", qPrintable(json));
+                return 2;
+            }
+            request[QLatin1String("args")] = doc.object();
+        }
+        requests = QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n';
+        count = 1;
+    }
+    else
+    {
+        QFile in;
+        if (!in.open(stdin, QIODevice::ReadOnly))
+            return 2;
+        while (!in.atEnd())
+        {
+            const QByteArray line = in.readLine().trimmed();
+            if (line.isEmpty())
+                continue;
+            requests += line + '\n';
+            ++count;
+        }
+    }
+
+    QLocalSocket socket;
+    socket.connectToServer(socketPath);
+    if (!socket.waitForConnected(3000))
+    {
+        fprintf(stderr, "Cannot connect to %s: %s\n", qPrintable(socketPath), qPrintable(socket.errorString()));
+        return 1;
+    }
+
+    // all requests are sent at once, the replies come back in the same order
+    socket.write(requests);
+    bool failed = false;
+    for (int replies = 0; replies < count; ++replies)
+    {
+        while (!socket.canReadLine())
+        {
+            if (!socket.waitForReadyRead(30000))
+            {
+                fprintf(stderr, "No reply: %s\n", qPrintable(socket.errorString()));
+                return 1;
+            }
+        }
+        const QByteArray line = socket.readLine();
+        if (!args.isEmpty())
+        {
+            const QJsonObject reply = QJsonDocument::fromJson(line).object();
+            if (reply.contains(QLatin1String("error")))
+            {
+                fprintf(stderr, "%s\n", qPrintable(reply.value(QLatin1String("error")).toString()));
+                failed = true;
+                continue;
+            }
+            const QJsonValue result = reply.value(QLatin1String("result"));
+            if (result.isObject())
+                fputs(QJsonDocument(result.toObject()).toJson(QJsonDocument::Indented).constData(), stdout);
+            else if (result.isArray())
+                fputs(QJsonDocument(result.toArray()).toJson(QJsonDocument::Indented).constData(), stdout);
+            else if (!result.isNull() && !result.isUndefined())
+                printf("%s\n", qPrintable(result.toVariant().toString()));
+            continue;
+        }
+        fwrite(line.constData(), 1, line.size(), stdout);
+    }
+    return failed ? 1 : 0;
+}
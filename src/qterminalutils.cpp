@@ -15,52 +15,231 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
  ***************************************************************************/
 
-#include <QRegularExpression>
-
 #include "qterminalutils.h"
 
 using namespace Qt::Literals::StringLiterals;
 
 QStringList parse_command(const QString& str)
 {
-    static const QRegularExpression separator(R"('|(?<!\\)(\\{2})*(\s|")|\z)"_L1);
-    static const QRegularExpression doubleQuote(R"((?<!\\)(\\{2})*")"_L1);
-    static const QRegularExpression escapedSpace(R"(\\(\\{2})*\s)"_L1);
-    static const QRegularExpression singleQuote(u"'"_s);
-
+    // POSIX shell quoting, without expansions: quotes and backslashes are
+    // removed, and unquoted whitespace separates the arguments
     QStringList list;
-    QRegularExpressionMatch match;
-    int index = 0;
-    int nextIndex = 0;
-    while((nextIndex = str.indexOf(separator, index, &match)) != -1)
+    QString token;
+    bool inToken = false;
+    const QChar *p = str.constData();
+    const QChar *end = p + str.size();
+    while (p < end)
     {
-        if (nextIndex > index)
+        const QChar c = *p;
+        if (c.isSpace())
         {
-            list << str.mid(index, nextIndex - index).replace(escapedSpace, QStringLiteral(" "));
-        }
-        if (match.capturedLength() == 0)
-        { // end of string ("\z") is matched
-            break;
+            if (inToken)
+            {
+                list << token;
+                token.clear();
+                inToken = false;
+            }
+            ++p;
+            continue;
         }
-        index = nextIndex + match.capturedLength();
-        auto c = str.at(index - 1); // last matched character
-        if (!c.isSpace())
-        { // a single quote or an unescaped double quote is matched
-            nextIndex = str.indexOf(c == QLatin1Char('\'') ? singleQuote : doubleQuote, index, &match);
-            if (nextIndex == -1)
-            { // the quote is not closed
-                break;
+
+        if (c == u'\\')
+        {
+            if (++p == end)
+            { // a trailing backslash is kept
+                token += c;
+                inToken = true;
             }
             else
             {
-                if (nextIndex > index)
+                if (*p != u'\n') // otherwise a line continuation
                 {
-                    list << str.mid(index, nextIndex - index).replace(escapedSpace, QStringLiteral(" "));
+                    token += *p;
+                    inToken = true;
                 }
-                index = nextIndex + match.capturedLength();
+                ++p;
             }
+            continue;
+        }
+
+        inToken = true;
+        if (c == u'\'')
+        { // everything up to the closing quote is literal
+            const QChar *begin = ++p;
+            while (p < end && *p != u'\'')
+                ++p;
+            token.append(begin, p - begin);
+            if (p < end)
+                ++p;
+        }
+        else if (c == u'"')
+        { // a backslash only escapes $ ` " \ and newline
+            ++p;
+            while (p < end && *p != u'"')
+            {
+                const QChar *begin = p;
+                while (p < end && *p != u'"' && *p != u'\\')
+                    ++p;
+                token.append(begin, p - begin);
+                if (p < end && *p == u'\\')
+                {
+                    if (p + 1 < end && (p[1] == u'$' || p[1] == u'`' || p[1] == u'"' || p[1] == u'\\'))
+                    {
+                        token += p[1];
+                        p += 2;
+                    }
+                    else if (p + 1 < end && p[1] == u'\n')
+                    {
+                        p += 2;
+                    }
+                    else
+                    {
+                        token += *p++;
+                    }
+                }
+            }
+            if (p < end)
+                ++p;
+        }
+        else
+        {
+            const QChar *begin = p;
+            while (p < end && !p->isSpace() && *p != u'\\' && *p != u'\'' && *p != u'"')
+                ++p;
+            token.append(begin, p - begin);
         }
     }
+    if (inToken)
+        list << token;
     return list;
 }
 
+QString quote_command(const QStringList& args)
+{
+    QString command;
+    for (const QString &arg : args)
+    {
+        if (!command.isEmpty())
+            command += u' ';
+
+        bool plain = !arg.isEmpty();
+        for (const QChar c : arg)
+        {
+            if (!(c.isLetterOrNumber() || QStringView(u"_@%+=:,./-").contains(c)))
+            {
+                plain = false;
+                break;
+            }
+        }
+        if (plain)
+        {
+            command += arg;
+            continue;
+        }
+
+        command += u'\'';
+        for (const QChar c : arg)
+        {
+            if (c == u'\'')
+                command += "'\\''"_L1;
+            else
+                command += c;
+        }
+        command += u'\'';
+    }
+    return command;
+}
+
+
+namespace {
+const int ScoreMatch = 16;
+const int BonusBoundary = 8;
+const int BonusConsecutive = 4;
+const int PenaltyGapStart = 3;
+const int PenaltyGapExtension = 1;
+
+bool isBoundary(QStringView text, qsizetype i)
+{
+    if (i == 0)
+        return true;
+    const QChar prev = text.at(i - 1);
+    return !prev.isLetterOrNumber() && text.at(i).isLetterOrNumber();
+}
+}
+
+int fuzzy_match(QStringView pattern, QStringView text)
+{
+    if (pattern.isEmpty())
+        return 0;
+    if (pattern.size() > text.size())
+        return -1;
+
+    // forward scan: find where the first complete occurrence ends
+    qsizetype p = 0;
+    qsizetype end = -1;
+    for (qsizetype i = 0; i < text.size(); ++i)
+    {
+        if (text.at(i) == pattern.at(p) && ++p == pattern.size())
+        {
+            end = i;
+            break;
+        }
+    }
+    if (end < 0)
+        return -1;
+
+    // backward scan: shrink the window from the left as far as possible
+    qsizetype start = end;
+    p = pattern.size() - 1;
+    for (qsizetype i = end; i >= 0; --i)
+    {
+        if (text.at(i) == pattern.at(p))
+        {
+            if (p == 0)
+            {
+                start = i;
+                break;
+            }
+            --p;
+        }
+    }
+
+    // score the window
+    int score = 0;
+    bool inGap = false;
+    qsizetype last = -1;
+    p = 0;
+    for (qsizetype i = start; i <= end; ++i)
+    {
+        if (p < pattern.size() && text.at(i) == pattern.at(p))
+        {
+            score += ScoreMatch;
+            if (isBoundary(text, i))
+                score += BonusBoundary;
+            if (last >= 0 && last == i - 1)
+                score += BonusConsecutive;
+            last = i;
+            inGap = false;
+            ++p;
+        }
+        else
+        {
+            score -= inGap ? PenaltyGapExtension : PenaltyGapStart;
+            inGap = true;
+        }
+    }
+    return qMax(score, 0);
+}
+
+QString paste_text(QString text, bool bracketed)
+{
+    text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+    text.replace(QLatin1Char('\n'), QLatin1Char('\r'));
+    if (bracketed)
+    {
+        text.remove(QLatin1Char('\x1b'));
+        text.prepend(QLatin1String("\x1b[200~"));
+        text.append(QLatin1String("\x1b[201~"));
+    }
+    return text;
+}
@@ -20,7 +20,22 @@
 
 #include <QString>
 #include <QStringList>
+#include <QStringView>
 
+// Splits a command line into arguments like a POSIX shell does, without
+// expanding anything.
 QStringList parse_command(const QString& str);
+// The inverse of parse_command(): quotes the arguments where needed.
+QString quote_command(const QStringList& args);
+
+// Subsequence ("fuzzy") match of pattern against text. Both are compared as-is,
+// so callers should case-fold them beforehand. Returns -1 when pattern is not a
+// subsequence of text, otherwise a score that is higher for tighter matches and
+// for matches at word starts.
+int fuzzy_match(QStringView pattern, QStringView text);
+
+// Pasted text as QTermWidget sends it: line breaks become CR, and in bracketed
+// paste mode ESC is removed, so that the text cannot end the paste early.
+QString paste_text(QString text, bool bracketed);
 
 #endif
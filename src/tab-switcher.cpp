@@ -1,10 +1,13 @@
 #include <QApplication>
 #include <QKeyEvent>
+#include <QPainter>
+#include <QSortFilterProxyModel>
 #include <QTimer>
 #include <QStyledItemDelegate>
 
 #include "tab-switcher.h"
 #include "tabwidget.h"
+#include "termwidgetholder.h"
 
 // -----------------------------------------------------------------------------------------------------------
 
@@ -15,12 +18,74 @@ enum class AppRole {
 
 // -----------------------------------------------------------------------------------------------------------
 
-AppModel::AppModel(QObject* parent, TabWidget* tabs):
-    QAbstractListModel(parent)
+AppModel::AppModel(TabWidget* tabs, QObject* parent):
+    QAbstractListModel(parent),
+    m_tabs(tabs)
 {
-    for(QWidget* w: tabs->history()) {
-        int index = w->property("tab_index").toInt();
-        m_list.append({tabs->tabText(index), index});
+    connect(tabs, &TabWidget::tabAdded, this, &AppModel::tabAdded);
+    connect(tabs, &TabWidget::tabRemoved, this, &AppModel::tabRemoved);
+    connect(tabs, &TabWidget::tabRenamed, this, &AppModel::tabRenamed);
+    connect(tabs, &QTabWidget::currentChanged, this, &AppModel::currentChanged);
+}
+
+int AppModel::rowOf(const QWidget* tab) const
+{
+    for (int i = 0; i < m_list.size(); ++i)
+    {
+        if (m_list.at(i).tab == tab)
+            return i;
+    }
+    return -1;
+}
+
+void AppModel::tabAdded(TermWidgetHolder* tab)
+{
+    if (rowOf(tab) != -1)
+        return; // already added as the current tab
+    const int index = m_tabs->indexOf(tab);
+    beginInsertRows(QModelIndex(), m_list.size(), m_list.size());
+    m_list.append({tab, index >= 0 ? m_tabs->tabText(index) : QString()});
+    endInsertRows();
+}
+
+void AppModel::tabRemoved(TermWidgetHolder* tab)
+{
+    const int row = rowOf(tab);
+    if (row == -1)
+        return;
+    beginRemoveRows(QModelIndex(), row, row);
+    m_list.removeAt(row);
+    endRemoveRows();
+}
+
+void AppModel::tabRenamed(TermWidgetHolder* tab, const QString& name)
+{
+    const int row = rowOf(tab);
+    if (row == -1 || m_list.at(row).name == name)
+        return;
+    m_list[row].name = name;
+    emit dataChanged(index(row), index(row));
+}
+
+void AppModel::currentChanged(int tabIndex)
+{
+    QWidget* tab = m_tabs->widget(tabIndex);
+    if (!tab)
+        return;
+    const int row = rowOf(tab);
+    if (row == 0)
+        return;
+    if (row == -1)
+    {
+        beginInsertRows(QModelIndex(), 0, 0);
+        m_list.prepend({tab, m_tabs->tabText(tabIndex)});
+        endInsertRows();
+    }
+    else
+    {
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), 0);
+        m_list.move(row, 0);
+        endMoveRows();
     }
 }
 
@@ -38,7 +103,7 @@ QVariant AppModel::data(const QModelIndex &index, int role) const
     case AppRole::Display:
         return m_list[index.row()].name;
     case AppRole::Index:
-        return m_list[index.row()].index;
+        return m_tabs->indexOf(m_list[index.row()].tab);
     }
 
     return {};
@@ -93,10 +158,18 @@ TabSwitcher::TabSwitcher(TabWidget *tabs)
     : QListView(tabs)
     , m_timer(new QTimer(this))
     , m_tabs(tabs)
+    , m_model(new AppModel(tabs, this))
+    , m_proxy(new QSortFilterProxyModel(this))
+    , m_cancelled(false)
 {
     setWindowFlags(Qt::Widget | Qt::Popup | Qt::WindowStaysOnTopHint);
     setItemDelegate(new AppItemDelegate(frameWidth(), tabs));
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setUniformItemSizes(true);
+
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    setModel(m_proxy);
 
     m_timer->setInterval(100);
     m_timer->setSingleShot(true);
@@ -108,25 +181,19 @@ TabSwitcher::~TabSwitcher() = default;
 
 void TabSwitcher::showSwitcher()
 {
-    setModel(new AppModel(this, m_tabs));
+    setFilter(QString());
 
     if (!model()->rowCount())
         return;
 
+    // all rows have the same height, so one size hint is enough
     QStyleOptionViewItem option;
+    initViewItemOption(&option);
+    const int rowHeight = itemDelegate()->sizeHint(option, model()->index(0, 0)).height();
+    const int maxApp = 16;
 
-    int w = 0;
-    int h = 0;
-    int maxApp = 15;
-
-    for(int i = 0; i < model()->rowCount(); ++i){
-        QSize siz = itemDelegate()->sizeHint(option, model()->index(i, 0));
-        w = qMax(w, siz.width());
-        h += siz.height();
-        if (i > maxApp)
-            break;
-    }
-
+    int w = m_tabs->width() * 2 / 3;
+    int h = rowHeight * qMin(model()->rowCount(), maxApp);
 
     w += 2 * frameWidth();
     h += 2 * frameWidth();
@@ -138,11 +205,22 @@ void TabSwitcher::showSwitcher()
     show();
 }
 
+void TabSwitcher::setFilter(const QString& filter)
+{
+    m_filter = filter;
+    m_proxy->setFilterFixedString(filter);
+    setCurrentIndex(model()->index(0, 0));
+    viewport()->update();
+}
+
 void TabSwitcher::selectItem(bool forward)
 {
     if (!isVisible())
         showSwitcher();
 
+    if (!model()->rowCount())
+        return;
+
     int current = currentIndex().row();
     current = (current < 0) ? 0 : current;
 
@@ -158,9 +236,49 @@ void TabSwitcher::selectItem(bool forward)
     setCurrentIndex(model()->index(current, 0));
 }
 
+void TabSwitcher::keyPressEvent(QKeyEvent *event)
+{
+    switch (event->key())
+    {
+    case Qt::Key_Escape:
+        m_cancelled = true;
+        close();
+        return;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        close();
+        return;
+    case Qt::Key_Backspace:
+        if (!m_filter.isEmpty())
+            setFilter(m_filter.chopped(1));
+        return;
+    default:
+        break;
+    }
+
+    // typing narrows the list down; the modifiers may still be held
+    QString text = event->text();
+    if (text.isEmpty() || !text.at(0).isPrint())
+    {
+        if (event->key() >= Qt::Key_Space && event->key() <= Qt::Key_AsciiTilde)
+            text = QChar(event->key()).toLower();
+        else
+            text.clear();
+    }
+    if (!text.isEmpty() && !(event->modifiers() & Qt::AltModifier))
+    {
+        m_timer->stop();
+        setFilter(m_filter + text);
+        return;
+    }
+
+    QListView::keyPressEvent(event);
+}
+
 void TabSwitcher::keyReleaseEvent(QKeyEvent *event)
 {
-    if (event->modifiers() == 0)
+    // once a filter is typed, the switcher stays open until Enter or Escape
+    if (event->modifiers() == 0 && m_filter.isEmpty())
         close();
 
     QWidget::keyReleaseEvent(event);
@@ -168,6 +286,8 @@ void TabSwitcher::keyReleaseEvent(QKeyEvent *event)
 
 void TabSwitcher::timer()
 {
+    if (!m_filter.isEmpty())
+        return;
     if (QApplication::queryKeyboardModifiers() == Qt::NoModifier)
         close();
     else
@@ -177,7 +297,25 @@ void TabSwitcher::timer()
 void TabSwitcher::closeEvent(QCloseEvent *)
 {
     m_timer->stop();
-    Q_EMIT activateTab(model()->data(model()->index(currentIndex().row(), 0), static_cast<int>(AppRole::Index)).value<int>());
+    const QModelIndex current = currentIndex();
+    if (!m_cancelled && current.isValid())
+        Q_EMIT activateTab(model()->data(current, static_cast<int>(AppRole::Index)).value<int>());
+    m_cancelled = false;
+}
+
+void TabSwitcher::paintEvent(QPaintEvent *event)
+{
+    QListView::paintEvent(event);
+    if (m_filter.isEmpty())
+        return;
+
+    QPainter painter(viewport());
+    QRect r = viewport()->rect().adjusted(4, 4, -4, -4);
+    QFont f = painter.font();
+    f.setItalic(true);
+    painter.setFont(f);
+    painter.setPen(palette().color(QPalette::PlaceholderText));
+    painter.drawText(r, Qt::AlignRight | Qt::AlignBottom, m_filter);
 }
 
 // -----------------------------------------------------------------------------------------------------------
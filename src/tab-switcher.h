@@ -3,26 +3,36 @@
 #include <QListWidget>
 #include <QAbstractListModel>
 
+class QSortFilterProxyModel;
 class TabWidget;
+class TermWidgetHolder;
 
 // -----------------------------------------------------------------------------------------------------------
 
+// Tabs in the order of their last activation, kept up to date by TabWidget's signals
 class AppModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
-    AppModel(QObject* parent, TabWidget* tabs);
+    AppModel(TabWidget* tabs, QObject* parent = nullptr);
 
 protected:
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
 private:
+    void tabAdded(TermWidgetHolder* tab);
+    void tabRemoved(TermWidgetHolder* tab);
+    void tabRenamed(TermWidgetHolder* tab, const QString& name);
+    void currentChanged(int index);
+    int rowOf(const QWidget* tab) const;
+
     struct AppInfo {
+        QWidget* tab;
         QString name;
-        int index;
     };
 
+    TabWidget* m_tabs;
     QList<AppInfo> m_list;
 };
 
@@ -41,17 +51,21 @@ signals:
     void activateTab(int index) const;
 
 protected:
+    void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
     void closeEvent(QCloseEvent *) override;
+    void paintEvent(QPaintEvent *event) override;
 
 private:
     void showSwitcher();
     void timer();
+    void setFilter(const QString& filter);
 
 private:
     QTimer *m_timer;
     TabWidget* m_tabs;
+    AppModel* m_model;
+    QSortFilterProxyModel* m_proxy;
+    QString m_filter;
+    bool m_cancelled;
 };
-
-// -----------------------------------------------------------------------------------------------------------
-
@@ -23,7 +23,8 @@
 #include <QMenu>
 #include <QActionGroup>
 #include <QMessageBox>
-#include <QTimer>
+#include <utility>
+#include <signal.h>
 
 #include "mainwindow.h"
 #include "termwidgetholder.h"
@@ -33,12 +34,13 @@
 #include "properties.h"
 #include "qterminalapp.h"
 #include "tab-switcher.h"
+#include "terminalprofile.h"
 
 
 #define TAB_INDEX_PROPERTY "tab_index"
 #define TAB_SYSTEM_TITLE_PROPERTY "system_title" // Store the system title when a custom one was set
 
-TabWidget::TabWidget(QWidget* parent) : QTabWidget(parent), tabNumerator(0), mTabBar(new TabBar(this)), mSwitcher(new TabSwitcher(this))
+TabWidget::TabWidget(QWidget* parent) : QTabWidget(parent), tabNumerator(0), mTabBar(new TabBar(this)), mSwitcher(new TabSwitcher(this)), mTitleTimer(new QTimer(this))
 {
     // Insert our own tab bar which overrides tab width and eliding
     setTabBar(mTabBar);
@@ -67,6 +69,10 @@ TabWidget::TabWidget(QWidget* parent) : QTabWidget(parent), tabNumerator(0), mTa
     connect(mSwitcher.data(), &TabSwitcher::activateTab, this, &TabWidget::switchTab);
     connect(this, &TabWidget::currentChanged, this, &TabWidget::onCurrentChanged);
     connect(this, &QTabWidget::currentChanged, this, &TabWidget::currentTitleChanged);
+
+    mTitleTimer->setSingleShot(true);
+    mTitleTimer->setInterval(250);
+    connect(mTitleTimer, &QTimer::timeout, this, &TabWidget::applyPendingTitles);
 }
 
 TabWidget::~TabWidget()
@@ -87,7 +93,7 @@ int TabWidget::addNewTab(TerminalConfig config, const QString &dbus_id)
 
     TermWidgetHolder *ch = terminalHolder();
     if (ch)
-        config.provideCurrentDirectory(ch->currentTerminal()->impl()->workingDirectory());
+        config.provideCurrentDirectory(ch->currentDirectory());
 
     TermWidgetHolder *console = new TermWidgetHolder(config, dbus_id, this);
     console->setWindowTitle(label);
@@ -100,6 +106,7 @@ int TabWidget::addNewTab(TerminalConfig config, const QString &dbus_id)
 
     console->setProperty(TAB_SYSTEM_TITLE_PROPERTY, QVariant()); // = no custom title
     updateTabIndices();
+    emit tabAdded(console);
     switchTab(index);
     console->setInitialFocus();
 
@@ -129,13 +136,11 @@ void TabWidget::switchBottomSubterminal() {
 void TabWidget::splitHorizontally()
 {
     terminalHolder()->splitHorizontal(terminalHolder()->currentTerminal());
-    findParent<MainWindow>(this)->updateDisabledActions();
 }
 
 void TabWidget::splitVertically()
 {
     terminalHolder()->splitVertical(terminalHolder()->currentTerminal());
-    findParent<MainWindow>(this)->updateDisabledActions();
 }
 
 void TabWidget::splitCollapse()
@@ -156,7 +161,6 @@ void TabWidget::splitCollapse()
     }
 
     terminalHolder()->splitCollapse(terminalHolder()->currentTerminal());
-    win->updateDisabledActions();
 }
 
 void TabWidget::copySelection()
@@ -197,7 +201,53 @@ void TabWidget::updateTabIndices()
 
 void TabWidget::onTermTitleChanged(const QString& title, const QString& icon)
 {
+    /* In xterm, the icon string maps to the X11 WM_ICON_NAME property.
+     * Doing nothing here for several reasons:
+     * 1. Few X11 window managers use that
+     * 2. X11-only code is involved
+     */
+    Q_UNUSED(icon);
+
     TermWidgetHolder * console = qobject_cast<TermWidgetHolder*>(sender());
+    /* Nobody sees the tabs of a hidden window, the last title is enough */
+    if (!isVisible())
+    {
+        mPendingTitles.insert(console, title);
+        return;
+    }
+    /* A busy background tab is relabelled a few times a second at most */
+    if (console != currentWidget())
+    {
+        mPendingTitles.insert(console, title);
+        if (!mTitleTimer->isActive())
+            mTitleTimer->start();
+        return;
+    }
+    mPendingTitles.remove(console);
+    setSystemTitle(console, title);
+}
+
+void TabWidget::showEvent(QShowEvent *event)
+{
+    QTabWidget::showEvent(event);
+    applyPendingTitles();
+}
+
+void TabWidget::applyPendingTitles()
+{
+    if (!isVisible())
+        return;
+    const auto pending = std::exchange(mPendingTitles, {});
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it)
+    {
+        // the tab may have been closed meanwhile
+        if (indexOf(it.key()) != -1)
+            setSystemTitle(it.key(), it.value());
+    }
+}
+
+void TabWidget::setSystemTitle(TermWidgetHolder *console, const QString &title)
+{
     /* Are we in the custom title mode ? */
     if (console->property(TAB_SYSTEM_TITLE_PROPERTY).isValid())
     {   /* Store the new system title to restore it when custom one will be stopped */
@@ -206,15 +256,11 @@ void TabWidget::onTermTitleChanged(const QString& title, const QString& icon)
     else
     {
         const int index = console->property(TAB_INDEX_PROPERTY).toInt();
-
-        /* In xterm, the icon string maps to the X11 WM_ICON_NAME property.
-         * Doing nothing here for several reasons:
-         * 1. Few X11 window managers use that
-         * 2. X11-only code is involved
-         */
-        Q_UNUSED(icon);
-
+        /* Prompts commonly set the same title over and over */
+        if (tabText(index) == title)
+            return;
         setTabText(index, title);
+        emit tabRenamed(console, title);
         if (currentIndex() == index)
             emit currentTitleChanged(index);
     }
@@ -255,6 +301,8 @@ void TabWidget::setLabel(int index, const QString &text)
         }
         /* else... no need to change the title */
     }
+    if (auto console = qobject_cast<TermWidgetHolder*>(widget(index)))
+        emit tabRenamed(console, tabText(index));
     if (currentIndex() == index)
         emit currentTitleChanged(index);
 }
@@ -312,6 +360,30 @@ void TabWidget::contextMenuEvent(QContextMenuEvent *event)
     rename->setShortcut(actions[QLatin1String(RENAME_SESSION)]->shortcut());
     rename->blockSignals(true);
 
+    TermWidgetHolder *holder = qobject_cast<TermWidgetHolder*>(widget(tabIndex));
+    const QStringList profiles = TerminalProfile::available();
+    QMenu *profileMenu = nullptr;
+    if (holder && !profiles.isEmpty())
+    {
+        const QString current = holder->profileName();
+        profileMenu = menu.addMenu(tr("Profile"));
+        QActionGroup *group = new QActionGroup(profileMenu);
+        QAction *defaultProfile = profileMenu->addAction(tr("Default"));
+        defaultProfile->setData(QString());
+        profileMenu->addSeparator();
+        for (const QString &profile : profiles)
+            profileMenu->addAction(profile)->setData(profile);
+        const auto profileActions = profileMenu->actions();
+        for (QAction *a : profileActions)
+        {
+            if (a->isSeparator())
+                continue;
+            a->setCheckable(true);
+            a->setChecked(a->data().toString() == current);
+            group->addAction(a);
+        }
+    }
+
     QAction *action = menu.exec(event->globalPos());
     if (action == close) {
         emit tabCloseRequested(tabIndex);
@@ -319,6 +391,8 @@ void TabWidget::contextMenuEvent(QContextMenuEvent *event)
         emit tabRenameRequested(tabIndex);
     } else if (action == changeColor) {
         emit tabTitleColorChangeRequested(tabIndex);
+    } else if (action && profileMenu && action->parent() == profileMenu) {
+        holder->setProfile(action->data().toString());
     }
 }
 
@@ -403,6 +477,7 @@ void TabWidget::removeTab(int index, bool prompt)
         QWidget * w = widget(index);
         mHistory.removeAll(w);
         QTabWidget::removeTab(index);
+        emit tabRemoved(qobject_cast<TermWidgetHolder*>(w));
         w->deleteLater();
 
         updateTabIndices();
@@ -422,6 +497,68 @@ void TabWidget::removeTab(int index, bool prompt)
     showHideTabBar();
 }
 
+void TabWidget::hangUp(const QList<TermWidget*> &terms)
+{
+    // Hang up the shells and their foreground jobs together, so that they exit
+    // in parallel instead of one by one as their terminals are deleted.
+    for (TermWidget *term : terms)
+    {
+        const int shell = term->impl()->getShellPID();
+        if (shell <= 0)
+            continue;
+        ::kill(-shell, SIGHUP);
+        const int foreground = term->impl()->getForegroundProcessId();
+        if (foreground > 0 && foreground != shell)
+            ::kill(-foreground, SIGHUP);
+    }
+}
+
+void TabWidget::takeTab(int index)
+{
+    TermWidgetHolder *w = qobject_cast<TermWidgetHolder*>(widget(index));
+    // their shells are going to finish, nothing should react to it
+    disconnect(w, nullptr, this, nullptr);
+    mHistory.removeAll(w);
+    mPendingTitles.remove(w);
+    QTabWidget::removeTab(index);
+    emit tabRemoved(w);
+    w->deleteLater();
+}
+
+void TabWidget::closeAllTabs()
+{
+    hangUp(findChildren<TermWidget*>());
+
+    // None of the per-tab work of removeTab() is needed for a closing window.
+    // Hidden, the tabs that become current on the way are neither shown nor built.
+    hide();
+    for (int i = count() - 1; i >= 0; --i)
+        takeTab(i);
+    mHistory.clear();
+}
+
+void TabWidget::removeTabs(const QList<TermWidgetHolder*> &holders)
+{
+    QList<TermWidget*> terms;
+    for (TermWidgetHolder *holder : holders)
+        terms << holder->findChildren<TermWidget*>();
+    hangUp(terms);
+
+    // the remaining tabs are updated once, not after each removal
+    setUpdatesEnabled(false);
+    for (int i = count() - 1; i >= 0; --i)
+    {
+        if (holders.contains(qobject_cast<TermWidgetHolder*>(widget(i))))
+            takeTab(i);
+    }
+    updateTabIndices();
+    if (TermWidgetHolder *current = terminalHolder())
+        current->setInitialFocus();
+    renameTabsAfterRemove();
+    showHideTabBar();
+    setUpdatesEnabled(true);
+}
+
 void TabWidget::switchTab(int index)
 {
     setCurrentIndex(index);
@@ -436,14 +573,22 @@ void TabWidget::onAction()
 
 void TabWidget::onCurrentChanged(int index)
 {
-    // update disabled actions, but only after probable subterminals are added
-    QTimer::singleShot(0, this, [this] {
-        findParent<MainWindow>(this)->updateDisabledActions();
-    });
-    // also, update history
+    // update history
     auto* w = widget(index);
     mHistory.removeAll(w);
     mHistory.prepend(w);
+
+    // the new current tab shows its latest title at once
+    if (auto console = qobject_cast<TermWidgetHolder*>(w))
+    {
+        const auto it = mPendingTitles.constFind(console);
+        if (it != mPendingTitles.constEnd() && isVisible())
+        {
+            const QString title = it.value();
+            mPendingTitles.erase(it);
+            setSystemTitle(console, title);
+        }
+    }
 }
 
 const QList<QWidget*>& TabWidget::history() const
@@ -575,14 +720,20 @@ void TabWidget::propertiesChanged()
         TermWidgetHolder *console = static_cast<TermWidgetHolder*>(widget(i));
         console->propertiesChanged();
     }
-    showHideTabBar();
+    const Properties *props = Properties::Instance();
+    if (props->isChanged(QStringLiteral("HideTabBarWithOneTab")) || props->isChanged(QStringLiteral("TabBarless")))
+        showHideTabBar();
 
-    setTabsClosable(Properties::Instance()->showCloseTabButton);
+    if (props->isChanged(QStringLiteral("ShowCloseTabButton")))
+        setTabsClosable(Properties::Instance()->showCloseTabButton);
 
     // Update the tab widths
-    mTabBar->setFixedWidth(Properties::Instance()->fixedTabWidth);
-    mTabBar->setFixedWidthValue(Properties::Instance()->fixedTabWidthValue);
-    mTabBar->updateWidth();
+    if (props->isChanged(QStringLiteral("FixedTabWidth")) || props->isChanged(QStringLiteral("FixedTabWidthValue")))
+    {
+        mTabBar->setFixedWidth(Properties::Instance()->fixedTabWidth);
+        mTabBar->setFixedWidthValue(Properties::Instance()->fixedTabWidthValue);
+        mTabBar->updateWidth();
+    }
 }
 
 void TabWidget::clearActiveTerminal()
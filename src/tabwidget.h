@@ -33,9 +33,11 @@
 
 class TabBar;
 class TermWidgetHolder;
+class TermWidget;
 class QAction;
 class QActionGroup;
 class TabSwitcher;
+class QTimer;
 
 class TabWidget : public QTabWidget
 {
@@ -51,6 +53,10 @@ public:
 
     bool hasRunningProcess() const;
     void setLabel(int, const QString&);
+    // removes all tabs at once when the window is closed, without prompting
+    void closeAllTabs();
+    // removes some tabs at once, without prompting; at least one tab must remain
+    void removeTabs(const QList<TermWidgetHolder*> &holders);
 
 public slots:
     int addNewTab(TerminalConfig cfg, const QString &dbus_id = QString());
@@ -105,6 +111,9 @@ signals:
     void tabRenameRequested(int);
     void tabTitleColorChangeRequested(int);
     void currentTitleChanged(int);
+    void tabAdded(TermWidgetHolder *holder);
+    void tabRemoved(TermWidgetHolder *holder);
+    void tabRenamed(TermWidgetHolder *holder, const QString &text);
 
 protected:
     enum Direction{Left = 1, Right};
@@ -116,6 +125,7 @@ protected:
         renaming or new tab opening
      */
     bool eventFilter(QObject *obj, QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
 protected slots:
     void updateTabIndices();
     void onTermTitleChanged(const QString& title, const QString& icon);
@@ -125,12 +135,20 @@ private:
     /* re-order naming of the tabs then removeCurrentTab() */
     void renameTabsAfterRemove();
     int switchTo(int index);
+    void setSystemTitle(TermWidgetHolder *console, const QString &title);
+    void applyPendingTitles();
+    void hangUp(const QList<TermWidget*> &terms);
+    void takeTab(int index);
 
     TabBar *mTabBar;
     QScopedPointer<TabSwitcher> mSwitcher;
     QList<QWidget*> mHistory;
 
     QMetaObject::Connection mFocusConnection;
+    // the latest titles of background tabs, or of all tabs while the window is
+    // hidden; applied by mTitleTimer, or when the window is shown
+    QHash<TermWidgetHolder*, QString> mPendingTitles;
+    QTimer *mTitleTimer;
 };
 
 #endif
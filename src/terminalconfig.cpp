@@ -19,7 +19,8 @@ TerminalConfig::TerminalConfig() = default;
 TerminalConfig::TerminalConfig(const TerminalConfig &cfg)
     : m_currentDirectory(cfg.m_currentDirectory),
       m_workingDirectory(cfg.m_workingDirectory),
-      m_shell(cfg.m_shell) {}
+      m_shell(cfg.m_shell),
+      m_profile(cfg.m_profile) {}
 
 QString TerminalConfig::getWorkingDirectory()
 {
@@ -51,6 +52,11 @@ bool TerminalConfig::hasCommand() const
     return !m_shell.isEmpty();
 }
 
+QString TerminalConfig::getProfile() const
+{
+    return m_profile;
+}
+
 void TerminalConfig::setWorkingDirectory(const QString &val)
 {
     m_workingDirectory = val;
@@ -66,12 +72,22 @@ void TerminalConfig::provideCurrentDirectory(const QString &val)
     m_currentDirectory = val;
 }
 
+void TerminalConfig::setProfile(const QString &val)
+{
+    m_profile = val;
+}
+
+void TerminalConfig::provideProfile(const QString &val)
+{
+    if (m_profile.isNull())
+        m_profile = val;
+}
 
 
-#if HAVE_QDBUS
 
 #define DBUS_ARG_WORKDIR "workingDirectory"
 #define DBUS_ARG_SHELL "shell"
+#define DBUS_ARG_PROFILE "profile"
 
 TerminalConfig TerminalConfig::fromDbus(const QHash<QString,QVariant> &termArgsConst, TermWidget *toSplit)
 {
@@ -80,6 +96,10 @@ TerminalConfig TerminalConfig::fromDbus(const QHash<QString,QVariant> &termArgsC
     {
         termArgs[QLatin1String(DBUS_ARG_WORKDIR)] = QVariant(toSplit->impl()->workingDirectory());
     }
+    if (toSplit != nullptr && !termArgs.contains(QLatin1String(DBUS_ARG_PROFILE)))
+    {
+        termArgs[QLatin1String(DBUS_ARG_PROFILE)] = QVariant(toSplit->impl()->profileName());
+    }
     return TerminalConfig::fromDbus(termArgs);
 }
 
@@ -100,6 +120,7 @@ static QStringList variantToStringList(const QVariant& variant, QStringList &def
 TerminalConfig TerminalConfig::fromDbus(const QHash<QString,QVariant> &termArgs)
 {
     QString wdir = QString();
+    QString profile = QString();
     QStringList shell(Properties::Instance()->shell);
     if (termArgs.contains(QLatin1String(DBUS_ARG_WORKDIR)))
     {
@@ -108,8 +129,10 @@ TerminalConfig TerminalConfig::fromDbus(const QHash<QString,QVariant> &termArgs)
     if (termArgs.contains(QLatin1String(DBUS_ARG_SHELL))) {
         shell = variantToStringList(termArgs[QLatin1String(DBUS_ARG_SHELL)], shell);
     }
-    return TerminalConfig(wdir, shell);
+    if (termArgs.contains(QLatin1String(DBUS_ARG_PROFILE))) {
+        profile = variantToString(termArgs[QLatin1String(DBUS_ARG_PROFILE)], profile);
+    }
+    TerminalConfig cfg(wdir, shell);
+    cfg.setProfile(profile);
+    return cfg;
 }
-
-#endif
-
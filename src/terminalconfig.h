@@ -18,15 +18,18 @@ class TerminalConfig
         QString getWorkingDirectory();
         QStringList getShell();
         bool hasCommand() const;
+        QString getProfile() const;
 
         void setWorkingDirectory(const QString &val);
         void setShell(const QStringList &val);
         void provideCurrentDirectory(const QString &val);
+        void setProfile(const QString &val);
+        // uses the profile unless one has been set explicitly
+        void provideProfile(const QString &val);
 
-        #ifdef HAVE_QDBUS
+        // from the termArgs of the D-Bus and control socket methods
         static TerminalConfig fromDbus(const QHash<QString,QVariant> &termArgs);
         static TerminalConfig fromDbus(const QHash<QString,QVariant> &termArgs, TermWidget *toSplit);
-        #endif
 
 
     private:
@@ -34,6 +37,7 @@ class TerminalConfig
     	QString m_currentDirectory;
     	QString m_workingDirectory;
         QStringList m_shell;
+        QString m_profile;
 };
 
 #endif
@@ -0,0 +1,156 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSettings>
+
+#include "terminalprofile.h"
+#include "properties.h"
+
+namespace {
+
+const QStringList profileKeys = {
+    QStringLiteral("fontFamily"),
+    QStringLiteral("fontSize"),
+    QStringLiteral("colorScheme"),
+    QStringLiteral("HistoryLimited"),
+    QStringLiteral("HistoryLimitedTo"),
+    QStringLiteral("emulation"),
+    QStringLiteral("TerminalBackgroundImage"),
+    QStringLiteral("TerminalBackgroundMode"),
+};
+
+struct RegistryEntry {
+    QWeakPointer<const TerminalProfile> profile;
+    quint64 generation;
+    QPair<qint64, qint64> fingerprint;
+};
+
+QHash<QString, RegistryEntry> registry;
+
+QString profilesDir()
+{
+    return Properties::Instance()->configDir() + QStringLiteral("/profiles");
+}
+
+QString profilePath(const QString &name)
+{
+    if (name.isEmpty())
+        return QString();
+    return profilesDir() + QLatin1Char('/') + name + QStringLiteral(".conf");
+}
+
+QPair<qint64, qint64> fingerprint(const QString &path)
+{
+    QFileInfo info(path);
+    if (path.isEmpty() || !info.exists())
+        return {-1, -1};
+    return {info.lastModified().toMSecsSinceEpoch(), info.size()};
+}
+
+} // namespace
+
+TerminalProfile::TerminalProfile(const QString &name)
+    : m_name(name)
+{
+    Properties *props = Properties::Instance();
+    m_font = props->font;
+    m_colorScheme = props->colorScheme;
+    m_historyLimited = props->historyLimited;
+    m_historyLimitedTo = props->historyLimitedTo;
+    m_emulation = props->emulation;
+    m_backgroundImage = props->backgroundImage;
+    m_backgroundMode = props->backgroundMode;
+
+    const QString path = profilePath(name);
+    if (path.isEmpty() || !QFileInfo::exists(path))
+        return;
+
+    QSettings settings(path, QSettings::IniFormat);
+    m_font = QFont(settings.value(QLatin1String("fontFamily"), m_font.family()).toString(),
+                   settings.value(QLatin1String("fontSize"), m_font.pointSize()).toInt());
+    m_colorScheme = settings.value(QLatin1String("colorScheme"), m_colorScheme).toString();
+    m_historyLimited = settings.value(QLatin1String("HistoryLimited"), m_historyLimited).toBool();
+    m_historyLimitedTo = settings.value(QLatin1String("HistoryLimitedTo"), m_historyLimitedTo).toUInt();
+    m_emulation = settings.value(QLatin1String("emulation"), m_emulation).toString();
+    m_backgroundImage = settings.value(QLatin1String("TerminalBackgroundImage"), m_backgroundImage).toString();
+    m_backgroundMode = qBound(0, settings.value(QLatin1String("TerminalBackgroundMode"), m_backgroundMode).toInt(), 5);
+}
+
+bool TerminalProfile::operator==(const TerminalProfile &other) const
+{
+    return m_name == other.m_name
+        && m_font == other.m_font
+        && m_colorScheme == other.m_colorScheme
+        && m_historyLimited == other.m_historyLimited
+        && m_historyLimitedTo == other.m_historyLimitedTo
+        && m_emulation == other.m_emulation
+        && m_backgroundImage == other.m_backgroundImage
+        && m_backgroundMode == other.m_backgroundMode;
+}
+
+QSharedPointer<const TerminalProfile> TerminalProfile::get(const QString &nameArg)
+{
+    // profile names are file names
+    const QString name = nameArg.contains(QLatin1Char('/')) ? QString() : nameArg;
+
+    Properties *props = Properties::Instance();
+    const QPair<qint64, qint64> fp = fingerprint(profilePath(name));
+    RegistryEntry &entry = registry[name];
+    QSharedPointer<const TerminalProfile> cached = entry.profile.toStrongRef();
+
+    if (cached && entry.fingerprint == fp)
+    {
+        if (entry.generation == props->generation())
+            return cached;
+        bool affected = false;
+        for (const QString &key : profileKeys)
+        {
+            if (props->isChanged(key))
+            {
+                affected = true;
+                break;
+            }
+        }
+        if (!affected)
+        {
+            entry.generation = props->generation();
+            return cached;
+        }
+    }
+
+    QSharedPointer<const TerminalProfile> profile(new TerminalProfile(name));
+    entry.generation = props->generation();
+    entry.fingerprint = fp;
+    // keep the old instance if nothing that matters has changed
+    if (cached && *cached == *profile)
+        return cached;
+    entry.profile = profile;
+    return profile;
+}
+
+QStringList TerminalProfile::available()
+{
+    QStringList names;
+    const QFileInfoList files = QDir(profilesDir()).entryInfoList({QStringLiteral("*.conf")}, QDir::Files, QDir::Name);
+    for (const QFileInfo &file : files)
+        names << file.completeBaseName();
+    return names;
+}
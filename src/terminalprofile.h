@@ -0,0 +1,65 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef TERMINALPROFILE_H
+#define TERMINALPROFILE_H
+
+#include <QFont>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+/*! \brief Appearance settings of a terminal.
+
+Profiles are read from "profiles/<name>.conf" in the config directory; keys that
+are not set there fall back to the global settings. The unnamed profile is the
+global settings alone. Profiles are immutable and shared: all terminals using
+the same profile hold the same instance until the profile or the global
+settings change.
+*/
+class TerminalProfile
+{
+    public:
+        static QSharedPointer<const TerminalProfile> get(const QString &name = QString());
+        static QStringList available();
+
+        const QString &name() const { return m_name; }
+        const QFont &font() const { return m_font; }
+        const QString &colorScheme() const { return m_colorScheme; }
+        bool historyLimited() const { return m_historyLimited; }
+        unsigned historyLimitedTo() const { return m_historyLimitedTo; }
+        const QString &emulation() const { return m_emulation; }
+        const QString &backgroundImage() const { return m_backgroundImage; }
+        int backgroundMode() const { return m_backgroundMode; }
+
+        bool operator==(const TerminalProfile &other) const;
+
+    private:
+        explicit TerminalProfile(const QString &name);
+
+        QString m_name;
+        QFont m_font;
+        QString m_colorScheme;
+        bool m_historyLimited;
+        unsigned m_historyLimitedTo;
+        QString m_emulation;
+        QString m_backgroundImage;
+        int m_backgroundMode;
+};
+
+#endif
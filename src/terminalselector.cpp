@@ -0,0 +1,132 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include <QDir>
+
+#include "terminalselector.h"
+#include "qterminalutils.h"
+
+TerminalSelector TerminalSelector::parse(const QString &expression, QString *error)
+{
+    auto fail = [error](const QString &reason) {
+        if (error)
+            *error = reason;
+        return TerminalSelector();
+    };
+
+    const QStringList tokens = parse_command(expression);
+    if (tokens.isEmpty())
+        return fail(QStringLiteral("empty selector"));
+
+    TerminalSelector selector;
+    qsizetype i = 0;
+    while (true)
+    {
+        Condition condition;
+        const QString &word = tokens.at(i);
+        if (word == QLatin1String("idle") || word == QLatin1String("busy"))
+        {
+            condition.op = word == QLatin1String("idle") ? Operator::Idle : Operator::Busy;
+            ++i;
+        }
+        else
+        {
+            if (i + 1 >= tokens.size())
+                return fail(QStringLiteral("expected an operator after \"%1\"").arg(word));
+            if (i + 2 >= tokens.size())
+                return fail(QStringLiteral("expected a value after \"%1\"").arg(tokens.at(i + 1)));
+            const QString &op = tokens.at(i + 1);
+            condition.key = word;
+            condition.value = tokens.at(i + 2);
+            if (op == QLatin1String("=="))
+                condition.op = Operator::Equal;
+            else if (op == QLatin1String("!="))
+                condition.op = Operator::NotEqual;
+            else if (op == QLatin1String("=~"))
+            {
+                condition.op = Operator::Glob;
+                condition.glob = QRegularExpression::fromWildcard(condition.value, Qt::CaseSensitive,
+                                                                  QRegularExpression::NonPathWildcardConversion);
+            }
+            else if (op == QLatin1String("under"))
+            {
+                condition.op = Operator::Under;
+                condition.value = QDir::cleanPath(condition.value);
+            }
+            else
+                return fail(QStringLiteral("unknown operator \"%1\"").arg(op));
+            i += 3;
+        }
+        selector.m_conditions << condition;
+
+        if (i == tokens.size())
+            break;
+        if (tokens.at(i) != QLatin1String("and"))
+            return fail(QStringLiteral("expected \"and\" before \"%1\"").arg(tokens.at(i)));
+        if (++i == tokens.size())
+            return fail(QStringLiteral("expected a condition after \"and\""));
+    }
+
+    selector.m_valid = true;
+    return selector;
+}
+
+bool TerminalSelector::matches(const QVariantMap &terminal) const
+{
+    if (!m_valid)
+        return false;
+
+    for (const Condition &condition : m_conditions)
+    {
+        const QString value = terminal.value(condition.key).toString();
+        bool ok = false;
+        switch (condition.op)
+        {
+        case Operator::Equal:
+            ok = value == condition.value;
+            break;
+        case Operator::NotEqual:
+            ok = value != condition.value;
+            break;
+        case Operator::Glob:
+            ok = condition.glob.match(value).hasMatch();
+            break;
+        case Operator::Under:
+        {
+            const QString path = QDir::cleanPath(value);
+            ok = !value.isEmpty()
+                 && (path == condition.value
+                     || path.startsWith(condition.value.endsWith(QLatin1Char('/')) ? condition.value
+                                                                                   : condition.value + QLatin1Char('/')));
+            break;
+        }
+        case Operator::Idle:
+        case Operator::Busy:
+        {
+            const int shell = terminal.value(QStringLiteral("shellPid")).toInt();
+            const int foreground = terminal.value(QStringLiteral("foregroundPid")).toInt();
+            const bool idle = shell > 0 && foreground == shell;
+            ok = condition.op == Operator::Idle ? idle : !idle;
+            break;
+        }
+        }
+        if (!ok)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef TERMINALSELECTOR_H
+#define TERMINALSELECTOR_H
+
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QVariantMap>
+
+/*! \brief A predicate over terminals, used to act on many of them at once.
+
+It is parsed from conditions joined by "and", for example
+\code
+foregroundProcess == ssh and cwd under /srv/app
+\endcode
+A condition is "key == value", "key != value", "key =~ glob", "key under path",
+"idle" (only the shell is running) or "busy". The keys are those of
+TermWidget::layoutInfo() plus "label", the text of the terminal's tab. The
+expression is split like a shell command line, so values can be quoted.
+
+Only terminals are matched, so tabs that have not been shown yet, and have no
+terminal and no shell, never match.
+*/
+class TerminalSelector
+{
+    public:
+        // an invalid selector with the reason in error when the expression is wrong
+        static TerminalSelector parse(const QString &expression, QString *error = nullptr);
+
+        bool isValid() const { return m_valid; }
+        bool matches(const QVariantMap &terminal) const;
+
+    private:
+        enum class Operator {
+            Equal,
+            NotEqual,
+            Glob,
+            Under,
+            Idle,
+            Busy
+        };
+        struct Condition {
+            Operator op;
+            QString key;
+            QString value;
+            QRegularExpression glob;
+        };
+
+        QList<Condition> m_conditions;
+        bool m_valid = false;
+};
+
+#endif
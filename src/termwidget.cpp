@@ -23,10 +23,28 @@
 #include <QMessageBox>
 #include <QAbstractButton>
 #include <QMouseEvent>
+#include <QFile>
+#include <QTimer>
+#include <QProgressBar>
+#include <QToolButton>
+#include <QHBoxLayout>
+#include <QApplication>
+#include <QBuffer>
 #include <cassert>
+#include <chrono>
+#include <utility>
 
 #ifdef HAVE_QDBUS
     #include <QtDBus/QtDBus>
+    #include <QJsonDocument>
+    #include <QJsonObject>
+    #include <QThread>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <signal.h>
+    #include <unistd.h>
+    #include <cerrno>
     #include "termwidgetholder.h"
     #include "terminaladaptor.h"
 #endif
@@ -41,6 +59,8 @@
 #include "properties.h"
 #include "qterminalapp.h"
 #include "qterminalutils.h"
+#include "ptywriter.h"
+#include "historyarchive.h"
 
 static int TermWidgetCount = 0;
 
@@ -59,6 +79,7 @@ TermWidgetImpl::TermWidgetImpl(TerminalConfig &cfg, QWidget * parent)
     setFlowControlWarningEnabled(FLOW_CONTROL_WARNING_ENABLED);
 
     m_hasCommand = cfg.hasCommand();
+    m_profileName = cfg.getProfile();
 
     propertiesChanged();
 
@@ -84,6 +105,13 @@ TermWidgetImpl::TermWidgetImpl(TerminalConfig &cfg, QWidget * parent)
             << QStringLiteral("QTERM_DBUS_OBJECT=%1").arg(tw->getDbusPathString());
     }
 #endif
+    const QString controlSocket = QTerminalApp::Instance()->controlSocketPath();
+    if (!controlSocket.isEmpty())
+    {
+        env << QStringLiteral("QTERM_CONTROL_SOCKET=%1").arg(controlSocket);
+        if (TermWidget *tw = qobject_cast<TermWidget*>(parent))
+            env << QStringLiteral("QTERM_CONTROL_OBJECT=%1").arg(tw->getDbusPathString());
+    }
     setEnvironment(env);
 
     setMotionAfterPasting(Properties::Instance()->m_motionAfterPaste);
@@ -104,6 +132,11 @@ TermWidgetImpl::TermWidgetImpl(TerminalConfig &cfg, QWidget * parent)
 
     connect(this, &QTermWidget::urlActivated, this, &TermWidgetImpl::activateUrl);
     connect(this, &QTermWidget::bell, this, &TermWidgetImpl::bell);
+    connect(this, &QTermWidget::receivedData, this, &TermWidgetImpl::trackBracketedPaste);
+    connect(this, &QTermWidget::finished, this, [this] {
+        m_bracketedPaste = false;
+        m_outputTail.clear();
+    });
 
     startShellProgram();
 }
@@ -119,65 +152,199 @@ TermWidgetImpl::~TermWidgetImpl()
 
 void TermWidgetImpl::propertiesChanged()
 {
-    setMargin(Properties::Instance()->terminalMargin);
-    setColorScheme(Properties::Instance()->colorScheme);
-    setTerminalFont(Properties::Instance()->font);
-    setMotionAfterPasting(Properties::Instance()->m_motionAfterPaste);
-    disableBracketedPasteMode(Properties::Instance()->m_disableBracketedPasteMode);
-    setConfirmMultilinePaste(Properties::Instance()->confirmMultilinePaste);
-    setWordCharacters(Properties::Instance()->wordCharacters);
-    autoHideMouseAfter(Properties::Instance()->mouseAutoHideDelay);
-    setTrimPastedTrailingNewlines(Properties::Instance()->trimPastedTrailingNewlines);
-    setTerminalSizeHint(Properties::Instance()->showTerminalSizeHint);
+    // settings applied from another instance only touch what they changed
+    const Properties *props = Properties::Instance();
+    auto changed = [props](const char *key) {
+        return props->isChanged(QLatin1String(key));
+    };
+
+    if (changed("TerminalMargin"))
+        setMargin(Properties::Instance()->terminalMargin);
+    updateProfile();
+    if (changed("MotionAfterPaste"))
+        setMotionAfterPasting(Properties::Instance()->m_motionAfterPaste);
+    if (changed("DisableBracketedPasteMode"))
+        disableBracketedPasteMode(Properties::Instance()->m_disableBracketedPasteMode);
+    if (changed("ConfirmMultilinePaste"))
+        setConfirmMultilinePaste(Properties::Instance()->confirmMultilinePaste);
+    if (changed("WordCharacters"))
+        setWordCharacters(Properties::Instance()->wordCharacters);
+    if (changed("MouseAutoHideDelay"))
+        autoHideMouseAfter(Properties::Instance()->mouseAutoHideDelay);
+    if (changed("TrimPastedTrailingNewlines"))
+        setTrimPastedTrailingNewlines(Properties::Instance()->trimPastedTrailingNewlines);
+    if (changed("showTerminalSizeHint"))
+        setTerminalSizeHint(Properties::Instance()->showTerminalSizeHint);
+
+    if (changed("TerminalTransparency"))
+        setTerminalOpacity(1.0 - Properties::Instance()->termTransparency/100.0);
+    if (changed("enabledBidiSupport"))
+        setBidiEnabled(Properties::Instance()->enabledBidiSupport);
+    if (changed("UseFontBoxDrawingChars"))
+        setDrawLineChars(!Properties::Instance()->useFontBoxDrawingChars);
+    if (changed("BoldIntense"))
+        setBoldIntense(Properties::Instance()->boldIntense);
 
-    if (Properties::Instance()->historyLimited)
+    /* be consequent with qtermwidget.h here */
+    if (changed("ScrollbarPosition"))
     {
-        setHistorySize(Properties::Instance()->historyLimitedTo);
+        switch(Properties::Instance()->scrollBarPos) {
+        case 0:
+            setScrollBarPosition(QTermWidget::NoScrollBar);
+            break;
+        case 1:
+            setScrollBarPosition(QTermWidget::ScrollBarLeft);
+            break;
+        case 2:
+        default:
+            setScrollBarPosition(QTermWidget::ScrollBarRight);
+            break;
+        }
+    }
+
+    if (changed("KeyboardCursorShape"))
+    {
+        switch(Properties::Instance()->keyboardCursorShape) {
+        case 1:
+            setKeyboardCursorShape(QTermWidget::KeyboardCursorShape::UnderlineCursor);
+            break;
+        case 2:
+            setKeyboardCursorShape(QTermWidget::KeyboardCursorShape::IBeamCursor);
+            break;
+        default:
+        case 0:
+            setKeyboardCursorShape(QTermWidget::KeyboardCursorShape::BlockCursor);
+            break;
+        }
+    }
+
+    if (changed("KeyboardCursorBlink"))
+        setBlinkingCursor(Properties::Instance()->keyboardCursorBlink && !m_suspended);
+
+    update();
+}
+
+void TermWidgetImpl::setProfile(const QString &name)
+{
+    m_profileName = name;
+    updateProfile();
+    update();
+}
+
+void TermWidgetImpl::updateProfile()
+{
+    // profiles are shared, an unchanged profile is still the same instance
+    QSharedPointer<const TerminalProfile> profile = TerminalProfile::get(m_profileName);
+    if (profile == m_profile)
+        return;
+    m_profile = profile;
+
+    setColorScheme(m_profile->colorScheme());
+    setTerminalFont(m_profile->font());
+    applyHistorySize();
+    setKeyBindings(m_profile->emulation());
+    setTerminalBackgroundImage(m_profile->backgroundImage());
+    setTerminalBackgroundMode(m_profile->backgroundMode());
+}
+
+void TermWidgetImpl::applyHistorySize()
+{
+    if (m_hibernated)
+        return; // restored by wake()
+    if (m_profile->historyLimited())
+    {
+        setHistorySize(m_profile->historyLimitedTo());
     }
     else
     {
         // Unlimited history
         setHistorySize(-1);
     }
+}
 
-    setKeyBindings(Properties::Instance()->emulation);
-    setTerminalOpacity(1.0 - Properties::Instance()->termTransparency/100.0);
-    setTerminalBackgroundImage(Properties::Instance()->backgroundImage);
-    setTerminalBackgroundMode(Properties::Instance()->backgroundMode);
-    setBidiEnabled(Properties::Instance()->enabledBidiSupport);
-    setDrawLineChars(!Properties::Instance()->useFontBoxDrawingChars);
-    setBoldIntense(Properties::Instance()->boldIntense);
+// while hibernated, output scrolls into a small history that is moved to disk in steps
+static const int HibernatedHistorySize = 10000;
 
-    /* be consequent with qtermwidget.h here */
-    switch(Properties::Instance()->scrollBarPos) {
-    case 0:
-        setScrollBarPosition(QTermWidget::NoScrollBar);
-        break;
-    case 1:
-        setScrollBarPosition(QTermWidget::ScrollBarLeft);
-        break;
-    case 2:
-    default:
-        setScrollBarPosition(QTermWidget::ScrollBarRight);
-        break;
-    }
-
-    switch(Properties::Instance()->keyboardCursorShape) {
-    case 1:
-        setKeyboardCursorShape(QTermWidget::KeyboardCursorShape::UnderlineCursor);
-        break;
-    case 2:
-        setKeyboardCursorShape(QTermWidget::KeyboardCursorShape::IBeamCursor);
-        break;
-    default:
-    case 0:
-        setKeyboardCursorShape(QTermWidget::KeyboardCursorShape::BlockCursor);
-        break;
-    }
-
-    setBlinkingCursor(Properties::Instance()->keyboardCursorBlink);
+int TermWidgetImpl::hibernatedHistorySize() const
+{
+    if (m_profile->historyLimited())
+        return qMin<int>(m_profile->historyLimitedTo(), HibernatedHistorySize);
+    return HibernatedHistorySize;
+}
 
-    update();
+bool TermWidgetImpl::archiveHistory()
+{
+    if (m_archive.isNull())
+    {
+        m_archive.reset(new HistoryArchive);
+        if (!m_archive->isValid())
+        {
+            m_archive.reset();
+            return false;
+        }
+    }
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    saveHistory(&buffer);
+    QByteArray text = buffer.buffer();
+    buffer.close();
+
+    // The screen stays in the terminal, only the rows scrolled off it are archived.
+    // A line wrapped across that boundary is archived whole.
+    if (!text.isEmpty() && !text.endsWith('\n'))
+        text += '\n';
+    const int columns = qMax(1, screenColumnsCount());
+    int rows = 0;
+    qsizetype end = text.size();
+    while (end > 0)
+    {
+        const qsizetype start = end >= 2 ? text.lastIndexOf('\n', end - 2) + 1 : 0;
+        const qsizetype length = QString::fromUtf8(text.constData() + start, end - start - 1).size();
+        rows += qMax<qsizetype>(1, (length + columns - 1) / columns);
+        if (rows > screenLinesCount())
+            break;
+        end = start;
+    }
+    text.truncate(end);
+    // no more than the profile's history is kept, archived or not
+    m_archive->append(std::move(text), m_profile->historyLimited() ? qsizetype(m_profile->historyLimitedTo()) : -1);
+
+    // dropping the history frees it
+    setHistorySize(0);
+    return true;
+}
+
+void TermWidgetImpl::hibernate()
+{
+    if (m_hibernated || !archiveHistory())
+        return;
+    m_hibernated = true;
+    setHistorySize(hibernatedHistorySize());
+}
+
+void TermWidgetImpl::archiveOutput()
+{
+    const int size = hibernatedHistorySize();
+    if (!m_hibernated || size == 0 || historyLinesCount() < qMax(1, size / 2))
+        return;
+    archiveHistory();
+    setHistorySize(size);
+}
+
+void TermWidgetImpl::wake()
+{
+    if (!m_hibernated)
+        return;
+    m_hibernated = false;
+    applyHistorySize();
+}
+
+void TermWidgetImpl::saveFullHistory(QIODevice *device)
+{
+    if (!m_archive.isNull())
+        device->write(m_archive->read(m_archive->chunkCount()));
+    saveHistory(device);
 }
 
 void TermWidgetImpl::customContextMenuCall(const QPoint & pos)
@@ -219,10 +386,6 @@ void TermWidgetImpl::customContextMenuCall(const QPoint & pos)
     menu.addAction(actions[QStringLiteral(HIDE_WINDOW_BORDERS)]);
     menu.addAction(actions[QStringLiteral(PREFERENCES)]);
 
-    // The disabled actions should be updated before showing the menu because
-    // the "Actions" menu of the main window may have not been shown yet.
-    mainWindow->updateDisabledActions();
-
     menu.exec(mapToGlobal(pos));
 }
 
@@ -246,7 +409,7 @@ void TermWidgetImpl::zoomReset()
 {
 // note: do not save zoom here due the #74 Zoom reset option resets font back to Monospace
 //    Properties::Instance()->font = Properties::Instance()->font;
-    setTerminalFont(Properties::Instance()->font);
+    setTerminalFont(m_profile->font());
 //    Properties::Instance()->saveSettings();
 }
 
@@ -271,8 +434,109 @@ void TermWidgetImpl::bell() {
     }
 }
 
+void TermWidgetImpl::hideEvent(QHideEvent *event)
+{
+    // A background tab, or any terminal of a hidden window: the cursor stops blinking.
+    // Hidden widgets are not painted anyway.
+    m_suspended = true;
+    setBlinkingCursor(false);
+    QTermWidget::hideEvent(event);
+}
+
+void TermWidgetImpl::showEvent(QShowEvent *event)
+{
+    wake();
+    if (m_suspended)
+    {
+        m_suspended = false;
+        setBlinkingCursor(Properties::Instance()->keyboardCursorBlink);
+    }
+    QTermWidget::showEvent(event);
+}
+
+void TermWidgetImpl::pasteClipboard()
+{
+    paste(QClipboard::Clipboard);
+}
+
+void TermWidgetImpl::pasteSelection()
+{
+    paste(QClipboard::Selection);
+}
+
+void TermWidgetImpl::paste(QClipboard::Mode mode)
+{
+    QString text = QApplication::clipboard()->text(mode);
+    // small pastes are sent at once by the library, as before
+    if (text.size() < 0x10000)
+    {
+        if (mode == QClipboard::Clipboard)
+            QTermWidget::pasteClipboard();
+        else
+            QTermWidget::pasteSelection();
+        return;
+    }
+
+    // do what QTermWidget would do with the text, but only once
+    if (Properties::Instance()->trimPastedTrailingNewlines)
+    {
+        while (text.endsWith(QLatin1Char('\n')) || text.endsWith(QLatin1Char('\r')))
+            text.chop(1);
+    }
+    if (Properties::Instance()->confirmMultilinePaste && text.contains(QLatin1Char('\n')))
+    {
+        QMessageBox confirmation(this);
+        confirmation.setWindowTitle(tr("Paste multiline text"));
+        confirmation.setText(tr("Are you sure you want to paste this text?"));
+        confirmation.setDetailedText(text.left(4096));
+        confirmation.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+        confirmation.setDefaultButton(QMessageBox::Yes);
+        if (confirmation.exec() != QMessageBox::Yes)
+            return;
+    }
+    const bool bracketed = m_bracketedPaste && !Properties::Instance()->m_disableBracketedPasteMode;
+    emit largePaste(paste_text(text, bracketed), bracketed);
+}
+
+void TermWidgetImpl::trackBracketedPaste(const QString &data)
+{
+    // one pass over the escape sequences of the block, preceded by the start of
+    // a sequence that was cut off at the end of the previous block
+    static const QLatin1StringView mode("[?2004");
+    QString joined;
+    QStringView text(data);
+    if (!m_outputTail.isEmpty())
+    {
+        joined = std::exchange(m_outputTail, QString()) + data;
+        text = joined;
+    }
+    qsizetype last = -1;
+    for (qsizetype pos = text.indexOf(QLatin1Char('\x1b')); pos >= 0; pos = text.indexOf(QLatin1Char('\x1b'), pos + 1))
+    {
+        last = pos;
+        const QStringView sequence = text.mid(pos + 1);
+        if (sequence.startsWith(QLatin1Char('c'))) // full reset
+            m_bracketedPaste = false;
+        else if (sequence.startsWith(mode) && sequence.size() > mode.size())
+        {
+            const QChar set = sequence.at(mode.size());
+            if (set == QLatin1Char('h') || set == QLatin1Char('l'))
+                m_bracketedPaste = set == QLatin1Char('h');
+        }
+    }
+    // shorter than ESC[?2004h, it may go on in the next block
+    if (last >= 0 && text.size() - last < mode.size() + 2)
+        m_outputTail = text.mid(last).toString();
+}
+
 bool TermWidget::eventFilter(QObject * /*obj*/, QEvent * ev)
 {
+    if (ev->type() == QEvent::KeyPress && m_pasteWriter
+        && static_cast<QKeyEvent*>(ev)->key() == Qt::Key_Escape)
+    {
+        cancelPaste();
+        return true;
+    }
     if (ev->type() == QEvent::MouseButtonPress)
     {
         QMouseEvent *mev = static_cast<QMouseEvent*>(ev);
@@ -305,10 +569,19 @@ TermWidget::TermWidget(TerminalConfig &cfg, const QString &dbus_id, QWidget *par
     , m_term(new TermWidgetImpl(cfg, this))
     , m_layout(new QVBoxLayout)
     , m_border(palette().color(QPalette::Window))
+    , m_activityTimer(new QTimer(this))
+    , m_activityPending(false)
+    , m_lastWriterId(0)
+    , m_pasteBar(nullptr)
+    , m_pasteProgress(nullptr)
+    , m_hibernateTimer(new QTimer(this))
+    , m_titleTimer(new QTimer(this))
 {
 
     #ifdef HAVE_QDBUS
     registerAdapter<TerminalAdaptor, TermWidget>(this);
+    if (QTerminalApp *app = qobject_cast<QTerminalApp*>(qApp))
+        emit app->terminalAdded(getDbusPath());
     #endif
 
     setFocusProxy(m_term);
@@ -330,18 +603,55 @@ TermWidget::TermWidget(TerminalConfig &cfg, const QString &dbus_id, QWidget *par
 
     propertiesChanged();
 
-    connect(m_term, &QTermWidget::finished, this, &TermWidget::finished);
+    m_activityTimer->setSingleShot(true);
+    m_activityTimer->setInterval(1000);
+    m_hibernateTimer->setSingleShot(true);
+    m_titleTimer->setSingleShot(true);
+    m_titleTimer->setInterval(16);
+
+    connect(m_term, &QTermWidget::finished, this, &TermWidget::term_finished);
     connect(m_term, &QTermWidget::termGetFocus, this, &TermWidget::term_termGetFocus);
     connect(m_term, &QTermWidget::termLostFocus, this, &TermWidget::term_termLostFocus);
-    connect(m_term, &QTermWidget::titleChanged, this, [this] { emit termTitleChanged(m_term->title(), m_term->icon()); });
+    connect(m_term, &QTermWidget::titleChanged, this, [this] {
+        if (!m_titleTimer->isActive())
+            m_titleTimer->start();
+    });
+    connect(m_titleTimer, &QTimer::timeout, this, &TermWidget::term_titleTimeout);
+    connect(m_term, &QTermWidget::bell, this, [this] { emit bell(); });
+    connect(m_term, &QTermWidget::receivedData, this, &TermWidget::term_receivedData);
+    connect(m_activityTimer, &QTimer::timeout, this, &TermWidget::term_activityTimeout);
+    connect(m_hibernateTimer, &QTimer::timeout, this, &TermWidget::term_idle);
+    connect(m_term, &TermWidgetImpl::largePaste, this, &TermWidget::startPaste);
+}
+
+TermWidget::~TermWidget()
+{
+    #ifdef HAVE_QDBUS
+    // terminals left at exit are destroyed after the application object
+    if (QTerminalApp *app = qobject_cast<QTerminalApp*>(qApp))
+        emit app->terminalRemoved(getDbusPath());
+    #endif
 }
 
 void TermWidget::propertiesChanged()
 {
-    if (Properties::Instance()->highlightCurrentTerminal)
-        m_layout->setContentsMargins(2, 2, 2, 2);
-    else
-        m_layout->setContentsMargins(0, 0, 0, 0);
+    const Properties *props = Properties::Instance();
+    if (props->isChanged(QStringLiteral("highlightCurrentTerminal")))
+    {
+        if (Properties::Instance()->highlightCurrentTerminal)
+            m_layout->setContentsMargins(2, 2, 2, 2);
+        else
+            m_layout->setContentsMargins(0, 0, 0, 0);
+    }
+
+    if (props->isChanged(QStringLiteral("HibernateAfter")))
+    {
+        m_hibernateTimer->setInterval(std::chrono::minutes(Properties::Instance()->hibernateAfter));
+        if (Properties::Instance()->hibernateAfter > 0)
+            m_hibernateTimer->start();
+        else
+            m_hibernateTimer->stop();
+    }
 
     m_term->propertiesChanged();
 }
@@ -351,6 +661,8 @@ void TermWidget::term_termGetFocus()
     m_border = palette().color(QPalette::Highlight);
     emit termGetFocus(this);
     update();
+    if (Properties::Instance()->hibernateAfter > 0)
+        m_hibernateTimer->start();
 }
 
 void TermWidget::term_termLostFocus()
@@ -359,6 +671,135 @@ void TermWidget::term_termLostFocus()
     update();
 }
 
+void TermWidget::term_receivedData()
+{
+    // throttled, the output itself can arrive thousands of times a second
+    if (m_activityTimer->isActive())
+    {
+        m_activityPending = true;
+        return;
+    }
+    emit activity();
+    checkCwd();
+    m_activityTimer->start();
+    m_term->archiveOutput();
+    if (Properties::Instance()->hibernateAfter > 0)
+        m_hibernateTimer->start();
+}
+
+void TermWidget::term_activityTimeout()
+{
+    if (!m_activityPending)
+        return;
+    m_activityPending = false;
+    emit activity();
+    checkCwd();
+    m_activityTimer->start();
+    m_term->archiveOutput();
+    if (Properties::Instance()->hibernateAfter > 0)
+        m_hibernateTimer->start();
+}
+
+void TermWidget::term_titleTimeout()
+{
+    const QString title = m_term->title();
+    const QString icon = m_term->icon();
+    if (title == m_title && icon == m_icon)
+        return;
+    m_title = title;
+    m_icon = icon;
+    emit termTitleChanged(title, icon);
+    emit titleChanged(title);
+}
+
+void TermWidget::term_idle()
+{
+    // a visible terminal starts counting again when it is hidden
+    if (!isVisible())
+        m_term->hibernate();
+}
+
+void TermWidget::hideEvent(QHideEvent *event)
+{
+    if (Properties::Instance()->hibernateAfter > 0)
+        m_hibernateTimer->start();
+    QWidget::hideEvent(event);
+}
+
+void TermWidget::term_finished()
+{
+    m_activityTimer->stop();
+    emit processExited();
+    emit finished();
+}
+
+void TermWidget::enqueueWriter(PtyWriter *writer)
+{
+    connect(writer, &PtyWriter::finished, this, [this, writer] {
+        m_writers.removeOne(writer);
+        writer->deleteLater();
+        if (!m_writers.isEmpty())
+            m_writers.constFirst()->start();
+    });
+    m_writers << writer;
+    if (m_writers.size() == 1)
+        writer->start();
+}
+
+void TermWidget::startPaste(const QString &text, bool bracketed)
+{
+    if (m_pasteBar == nullptr)
+    {
+        m_pasteBar = new QWidget(this);
+        QHBoxLayout *layout = new QHBoxLayout(m_pasteBar);
+        layout->setContentsMargins(4, 2, 4, 2);
+        m_pasteProgress = new QProgressBar(m_pasteBar);
+        m_pasteProgress->setRange(0, 1000);
+        m_pasteProgress->setFormat(tr("Pasting %p%"));
+        QToolButton *cancel = new QToolButton(m_pasteBar);
+        cancel->setText(tr("Cancel"));
+        cancel->setToolTip(tr("Stop pasting (Esc)"));
+        connect(cancel, &QToolButton::clicked, this, &TermWidget::cancelPaste);
+        layout->addWidget(m_pasteProgress, 1);
+        layout->addWidget(cancel);
+        m_layout->addWidget(m_pasteBar);
+    }
+    // one paste at a time
+    cancelPaste();
+
+    PtyWriter *writer = new PtyWriter(m_term, text, this);
+    m_pasteWriter = writer;
+    connect(writer, &PtyWriter::progress, this, [this](qint64 written, qint64 total) {
+        if (total > 0)
+            m_pasteProgress->setValue(static_cast<int>(written * 1000 / total));
+    });
+    connect(writer, &PtyWriter::finished, this, [this, writer, bracketed](bool ok) {
+        // a cancelled bracketed paste would leave the program in paste mode
+        if (!ok && bracketed && writer->written() > 0)
+            m_term->sendText(QStringLiteral("\x1b[201~"));
+        if (m_pasteWriter == writer)
+            m_pasteBar->hide();
+    });
+    m_pasteProgress->setValue(0);
+    m_pasteBar->show();
+    enqueueWriter(writer);
+}
+
+void TermWidget::cancelPaste()
+{
+    if (m_pasteWriter)
+        m_pasteWriter->cancel();
+}
+
+void TermWidget::checkCwd()
+{
+    const QString cwd = m_term->workingDirectory();
+    if (cwd.isEmpty() || cwd == m_cwd)
+        return;
+    m_cwd = cwd;
+    emit cwdChanged(m_cwd);
+}
+
 void TermWidget::paintEvent (QPaintEvent *)
 {
   if (Properties::Instance()->highlightCurrentTerminal)
@@ -482,4 +923,202 @@ void TermWidget::setSize(int columns, int lines)
     }
 }
 
+namespace {
+
+enum class ExportFormat { Invalid, Text, JsonLines };
+
+ExportFormat exportFormat(const QString &format)
+{
+    if (format.isEmpty() || format == QLatin1String("text"))
+        return ExportFormat::Text;
+    if (format == QLatin1String("jsonl"))
+        return ExportFormat::JsonLines;
+    // QTermWidget does not expose character attributes, so there is no "ansi"
+    return ExportFormat::Invalid;
+}
+
+// a reader that takes no data for this long is given up on
+const int ExportTimeout = 30000;
+
+bool writeAll(int fd, const char *data, qint64 size)
+{
+    while (size > 0)
+    {
+        const ssize_t written = ::write(fd, data, size);
+        if (written >= 0)
+        {
+            data += written;
+            size -= written;
+            continue;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            return false;
+        pollfd ready = {fd, POLLOUT, 0};
+        const int count = ::poll(&ready, 1, ExportTimeout);
+        if (count == 0 || (count < 0 && errno != EINTR))
+            return false;
+    }
+    return true;
+}
+
+// Writes the lines [first, last) of the archived and the live history to fd and closes it.
+// Runs on a thread of its own, the work and a slow reader must not block the GUI.
+void writeLines(int fd, const QSharedPointer<HistoryArchive> &archive, int chunks, qsizetype archivedLines,
+                const QByteArray &live, qsizetype first, qsizetype last, ExportFormat format)
+{
+    sigset_t pipeSignal, oldMask;
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+    // a reader going away must not kill the process
+    pthread_sigmask(SIG_BLOCK, &pipeSignal, &oldMask);
+
+    // the archive is only decompressed when lines of it are asked for
+    qsizetype line = archivedLines;
+    QByteArray text = live;
+    if (first < archivedLines)
+    {
+        // the oldest lines may have been dropped meanwhile, the others keep their numbers
+        qsizetype kept = 0;
+        text.prepend(archive->read(chunks, &kept));
+        line -= kept;
+    }
+
+    qsizetype pos = 0;
+    while (line < first && pos < text.size())
+    {
+        const qsizetype newline = text.indexOf('\n', pos);
+        pos = newline < 0 ? text.size() : newline + 1;
+        ++line;
+    }
+
+    bool ok = true;
+    QByteArray chunk;
+    const qsizetype begin = pos;
+    for (; ok && line < last && pos < text.size(); ++line)
+    {
+        const qsizetype newline = text.indexOf('\n', pos);
+        const qsizetype next = newline < 0 ? text.size() : newline + 1;
+        if (format == ExportFormat::JsonLines)
+        {
+            QJsonObject object;
+            object[QLatin1String("line")] = line;
+            object[QLatin1String("text")] = QString::fromUtf8(text.constData() + pos, (newline < 0 ? next : newline) - pos);
+            chunk += QJsonDocument(object).toJson(QJsonDocument::Compact);
+            chunk += '\n';
+            if (chunk.size() >= 64 * 1024)
+            {
+                ok = writeAll(fd, chunk.constData(), chunk.size());
+                chunk.clear();
+            }
+        }
+        pos = next;
+    }
+    // the lines are contiguous, text is written straight from the history
+    if (format == ExportFormat::Text)
+        chunk = QByteArray::fromRawData(text.constData() + begin, pos - begin);
+    if (ok && !chunk.isEmpty())
+        ok = writeAll(fd, chunk.constData(), chunk.size());
+
+    if (!ok && errno == EPIPE)
+    {
+        // consume the pending signal before unblocking it again
+        const timespec noWait = {0, 0};
+        sigtimedwait(&pipeSignal, nullptr, &noWait);
+    }
+    pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+    ::close(fd);
+}
+
+} // namespace
+
+int TermWidget::readScreen(const QString &format, const QDBusUnixFileDescriptor &fd)
+{
+    // the screen is the end of the history
+    return exportLines(-m_term->screenLinesCount(), -1, format, fd);
+}
+
+int TermWidget::readHistory(int fromLine, int count, const QString &format, const QDBusUnixFileDescriptor &fd)
+{
+    return exportLines(fromLine, count, format, fd);
+}
+
+uint TermWidget::sendFromFd(const QDBusUnixFileDescriptor &fd)
+{
+    // each queued send holds a descriptor open
+    static const int MaxQueuedSends = 16;
+    if (!fd.isValid() || m_writers.size() >= MaxQueuedSends)
+        return 0;
+    const int source = ::fcntl(fd.fileDescriptor(), F_DUPFD_CLOEXEC, 0);
+    if (source < 0)
+        return 0;
+
+    const uint id = ++m_lastWriterId;
+    PtyWriter *writer = new PtyWriter(m_term, source, this);
+    connect(writer, &PtyWriter::finished, this, [this, writer, id](bool ok) {
+        emit sendFinished(id, writer->written(), ok);
+    });
+    enqueueWriter(writer);
+    return id;
+}
+
+int TermWidget::exportLines(int fromLine, int count, const QString &format, const QDBusUnixFileDescriptor &fd)
+{
+    const ExportFormat exportAs = exportFormat(format);
+    if (exportAs == ExportFormat::Invalid || !fd.isValid())
+        return -1;
+
+    // QTermWidget only hands out its history as a whole; the rest is left to the thread
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    m_term->saveHistory(&buffer);
+    const QByteArray live = buffer.buffer();
+    const qsizetype liveLines = live.count('\n') + (live.endsWith('\n') || live.isEmpty() ? 0 : 1);
+
+    const QSharedPointer<HistoryArchive> archive = m_term->archive();
+    const int chunks = archive ? archive->chunkCount() : 0;
+    const qsizetype archivedLines = archive ? archive->lineCount() : 0;
+    const qsizetype lines = archivedLines + liveLines;
+
+    const qsizetype first = fromLine < 0 ? qMax<qsizetype>(0, lines + fromLine) : qMin<qsizetype>(fromLine, lines);
+    const qsizetype last = count < 0 ? lines : qMin<qsizetype>(lines, first + count);
+
+    // the passed descriptor is closed when this call returns
+    const int out = ::fcntl(fd.fileDescriptor(), F_DUPFD_CLOEXEC, 0);
+    if (out < 0)
+        return -1;
+    ::fcntl(out, F_SETFL, ::fcntl(out, F_GETFL) | O_NONBLOCK);
+    QThread *thread = QThread::create(writeLines, out, archive, chunks, archivedLines, live, first, last, exportAs);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start();
+    return static_cast<int>(last - first);
+}
+
 #endif
+
+static QString processName(int pid)
+{
+    QFile comm(QStringLiteral("/proc/%1/comm").arg(pid));
+    if (pid <= 0 || !comm.open(QIODevice::ReadOnly))
+        return QString();
+    return QString::fromLocal8Bit(comm.readAll()).trimmed();
+}
+
+QVariantMap TermWidget::layoutInfo()
+{
+    const int pid = m_term->getForegroundProcessId();
+
+    QVariantMap info;
+    info[QStringLiteral("terminal")] = getDbusPathString();
+    info[QStringLiteral("title")] = m_term->title();
+    info[QStringLiteral("cwd")] = m_term->workingDirectory();
+    info[QStringLiteral("shellPid")] = m_term->getShellPID();
+    info[QStringLiteral("foregroundPid")] = pid;
+    info[QStringLiteral("foregroundProcess")] = processName(pid);
+    info[QStringLiteral("columns")] = m_term->screenColumnsCount();
+    info[QStringLiteral("lines")] = m_term->screenLinesCount();
+    info[QStringLiteral("profile")] = m_term->profileName();
+    info[QStringLiteral("hibernated")] = m_term->isHibernated();
+    return info;
+}
@@ -22,10 +22,18 @@
 #include <qtermwidget6/qtermwidget.h>
 
 #include "terminalconfig.h"
+#include "terminalprofile.h"
 
 #include <QAction>
+#include <QClipboard>
+#include <QPointer>
 #include "dbusaddressable.h"
 
+class QProgressBar;
+class QTimer;
+class PtyWriter;
+class HistoryArchive;
+
 #ifdef HAVE_LIBCANBERRA
 // forwarded declaration from <canberra.h>
 struct ca_context;
@@ -47,22 +55,70 @@ class TermWidgetImpl : public QTermWidget
             return m_hasCommand;
         }
 
+        QString profileName() const {
+            return m_profileName;
+        }
+        void setProfile(const QString &name);
+
+        // Moves the history into a compressed file and frees it, the shell keeps running.
+        // The archived lines are not shown again; they are only part of exports.
+        void hibernate();
+        void wake();
+        bool isHibernated() const {
+            return m_hibernated;
+        }
+        // moves the output received while hibernated to disk, call it now and then
+        void archiveOutput();
+        // like saveHistory(), including what was moved to disk
+        void saveFullHistory(QIODevice *device);
+        QSharedPointer<HistoryArchive> archive() const {
+            return m_archive;
+        }
+
     signals:
         void renameSession();
         void removeCurrentSession();
+        // already processed like QTermWidget would, to be sent in chunks
+        void largePaste(const QString &text, bool bracketed);
 
     public slots:
         void zoomIn();
         void zoomOut();
         void zoomReset();
         void customContextMenuCall(const QPoint & pos);
+        // hide QTermWidget's, large pastes are streamed
+        void pasteClipboard();
+        void pasteSelection();
 
     private slots:
         void activateUrl(const QUrl& url, bool fromContextMenu);
         void bell();
 
+    protected:
+        void showEvent(QShowEvent *event) override;
+        void hideEvent(QHideEvent *event) override;
+
     private:
+        void updateProfile();
+        void applyHistorySize();
+        bool archiveHistory();
+        int hibernatedHistorySize() const;
+        void paste(QClipboard::Mode mode);
+        void trackBracketedPaste(const QString &data);
+
+        // whether the program has turned on bracketed paste
+        bool m_bracketedPaste = false;
+        // an escape sequence that may be split between two output blocks
+        QString m_outputTail;
+        // not blinking while hidden, see hideEvent()
+        bool m_suspended = false;
+        bool m_hibernated = false;
+        // history scrolled off before hibernating, oldest first
+        QSharedPointer<HistoryArchive> m_archive;
+
         bool m_hasCommand;
+        QString m_profileName;
+        QSharedPointer<const TerminalProfile> m_profile;
 #ifdef HAVE_LIBCANBERRA
         ca_context* libcanberra_context;
 #endif
@@ -76,14 +132,30 @@ class TermWidget : public QWidget, public DBusAddressable
     TermWidgetImpl * m_term;
     QVBoxLayout * m_layout;
     QColor m_border;
+    QTimer * m_activityTimer;
+    bool m_activityPending;
+    QString m_cwd;
+    // queued input, the first one is being sent
+    QList<PtyWriter*> m_writers;
+    uint m_lastWriterId;
+    QPointer<PtyWriter> m_pasteWriter;
+    QWidget * m_pasteBar;
+    QProgressBar * m_pasteProgress;
+    QTimer * m_hibernateTimer;
+    // title changes are passed on at most once per frame
+    QTimer * m_titleTimer;
+    QString m_title;
+    QString m_icon;
 
     public:
         TermWidget(TerminalConfig &cfg, const QString &dbus_id = QString(), QWidget * parent=nullptr);
+        ~TermWidget() override;
 
         void propertiesChanged();
         QStringList availableKeyBindings() { return m_term->availableKeyBindings(); }
 
         TermWidgetImpl * impl() { return m_term; }
+        QVariantMap layoutInfo();
 
         #ifdef HAVE_QDBUS
         QDBusObjectPath splitHorizontal(const QHash<QString,QVariant> &termArgs);
@@ -97,6 +169,9 @@ class TermWidget : public QWidget, public DBusAddressable
         void setBackgroundImage(const QString &image, const int mode);
         void setFont(const QString& font, const int pointSize);
         void setSize(int cloumns, int lines);
+        int readScreen(const QString &format, const QDBusUnixFileDescriptor &fd);
+        int readHistory(int fromLine, int count, const QString &format, const QDBusUnixFileDescriptor &fd);
+        uint sendFromFd(const QDBusUnixFileDescriptor &fd);
         #endif
 
         bool eventFilter(QObject * obj, QEvent * evt) override;
@@ -110,6 +185,13 @@ class TermWidget : public QWidget, public DBusAddressable
         void splitCollapse(TermWidget * self);
         void termGetFocus(TermWidget * self);
         void termTitleChanged(QString titleText, QString icon);
+        // relayed by the D-Bus adaptor
+        void titleChanged(const QString &title);
+        void cwdChanged(const QString &cwd);
+        void processExited();
+        void bell();
+        void activity();
+        void sendFinished(uint id, qulonglong bytes, bool ok);
 
     public slots:
 
@@ -119,10 +201,26 @@ class TermWidget : public QWidget, public DBusAddressable
             return false;
         }
         void paintEvent (QPaintEvent * event) override;
+        void hideEvent(QHideEvent *event) override;
 
     private slots:
         void term_termGetFocus();
         void term_termLostFocus();
+        void term_receivedData();
+        void term_activityTimeout();
+        void term_finished();
+        void term_idle();
+        void term_titleTimeout();
+
+        void startPaste(const QString &text, bool bracketed);
+        void cancelPaste();
+
+    private:
+        void checkCwd();
+        void enqueueWriter(PtyWriter *writer);
+        #ifdef HAVE_QDBUS
+        int exportLines(int fromLine, int count, const QString &format, const QDBusUnixFileDescriptor &fd);
+        #endif
 };
 
 #endif
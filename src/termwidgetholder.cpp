@@ -19,6 +19,7 @@
 #include <QGridLayout>
 #include <QSplitter>
 #include <QInputDialog>
+#include <QTimer>
 
 #ifdef HAVE_QDBUS
     #include <QtDBus/QtDBus>
@@ -38,9 +39,11 @@
 
 TermWidgetHolder::TermWidgetHolder(TerminalConfig &config, const QString &dbus_id, QWidget * parent)
     : QWidget(parent)
-      #ifdef HAVE_QDBUS
-      , DBusAddressable(QStringLiteral("/tabs"), dbus_id)
-      #endif
+    , DBusAddressable(QStringLiteral("/tabs"), dbus_id)
+    , m_currentTerm(nullptr)
+    , m_config(config)
+    , m_dbusId(dbus_id)
+    , m_terminalCount(0)
 {
     #ifdef HAVE_QDBUS
     new TabAdaptor(this);
@@ -51,17 +54,57 @@ TermWidgetHolder::TermWidgetHolder(TerminalConfig &config, const QString &dbus_i
     lay->setSpacing(0);
     lay->setContentsMargins(0, 0, 0, 0);
 
+    setLayout(lay);
+
+    // the shell starts soon, but the GUI stays responsive while many tabs are created
+    if (Properties::Instance()->startTabsEagerly)
+        QTimer::singleShot(0, this, &TermWidgetHolder::materialize);
+}
+
+TermWidgetHolder::~TermWidgetHolder() = default;
+
+void TermWidgetHolder::materialize()
+{
+    if (m_currentTerm != nullptr)
+        return;
+
     QSplitter *s = new QSplitter(this);
     s->setFocusPolicy(Qt::NoFocus);
-    TermWidget *w = newTerm(config, dbus_id);
+    TermWidget *w = newTerm(m_config, m_dbusId);
     s->addWidget(w);
-    lay->addWidget(s);
+    layout()->addWidget(s);
     m_currentTerm = w;
 
-    setLayout(lay);
+    if (isVisible())
+        w->setFocus(Qt::OtherFocusReason);
 }
 
-TermWidgetHolder::~TermWidgetHolder() = default;
+void TermWidgetHolder::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (m_currentTerm == nullptr)
+    {
+        // tabs passed through while switching in a loop are not built
+        QTimer::singleShot(0, this, [this] {
+            if (isVisible())
+                materialize();
+        });
+    }
+}
+
+QString TermWidgetHolder::profileName() const
+{
+    if (m_currentTerm == nullptr)
+        return m_config.getProfile();
+    return m_currentTerm->impl()->profileName();
+}
+
+QString TermWidgetHolder::currentDirectory()
+{
+    if (m_currentTerm == nullptr)
+        return m_config.getWorkingDirectory();
+    return m_currentTerm->impl()->workingDirectory();
+}
 
 void TermWidgetHolder::setInitialFocus()
 {
@@ -131,6 +174,7 @@ void TermWidgetHolder::saveSession(const QString & name)
 
 TermWidget* TermWidgetHolder::currentTerminal()
 {
+    materialize();
     return m_currentTerm;
 }
 
@@ -198,6 +242,10 @@ static NavigationData getNormalizedDimensions(QWidget *w, NavigationDirection di
 void TermWidgetHolder::directionalNavigation(NavigationDirection dir) {
     // Find an active widget
     QList<TermWidget*> l = findChildren<TermWidget*>();
+    if (!isMaterialized() || l.isEmpty())
+    {
+        return;
+    }
     int ix = -1;
     for (TermWidget * w : std::as_const(l))
     {
@@ -266,6 +314,14 @@ void TermWidgetHolder::propertiesChanged()
         w->propertiesChanged();
 }
 
+void TermWidgetHolder::setProfile(const QString &name)
+{
+    m_config.setProfile(name);
+    const auto ws = findChildren<TermWidget*>();
+    for(TermWidget *w : ws)
+        w->impl()->setProfile(name);
+}
+
 void TermWidgetHolder::splitHorizontal(TermWidget * term)
 {
     TerminalConfig defaultConfig;
@@ -284,6 +340,8 @@ void TermWidgetHolder::splitCollapse(TermWidget * term)
     assert(parent);
     term->setParent(nullptr);
     delete term;
+    --m_terminalCount;
+    emit terminalsChanged();
 
     QWidget *nextFocus = Q_NULLPTR;
 
@@ -343,6 +401,7 @@ TermWidget * TermWidgetHolder::split(TermWidget *term, Qt::Orientation orientati
     s->insertWidget(0, term);
 
     cfg.provideCurrentDirectory(term->impl()->workingDirectory());
+    cfg.provideProfile(term->impl()->profileName());
 
     TermWidget * w = newTerm(cfg, dbus_id);
     s->insertWidget(1, w);
@@ -372,6 +431,9 @@ TermWidget *TermWidgetHolder::newTerm(TerminalConfig &cfg, const QString &dbus_i
     connect(w, &TermWidget::termGetFocus, this, &TermWidgetHolder::setCurrentTerminal);
     connect(w, &TermWidget::termTitleChanged, this, &TermWidgetHolder::onTermTitleChanged);
 
+    ++m_terminalCount;
+    emit terminalAdded(w);
+    emit terminalsChanged();
     return w;
 }
 
@@ -425,31 +487,46 @@ bool TermWidgetHolder::hasRunningProcess() const
     return false;
 }
 
-#ifdef HAVE_QDBUS
-
-QDBusObjectPath TermWidgetHolder::getActiveTerminal()
+static QVariantMap splitterInfo(QSplitter *splitter)
 {
-    if (m_currentTerm != nullptr)
+    const QList<int> sizes = splitter->sizes();
+    int total = 0;
+    for (const int size : sizes)
+        total += size;
+
+    QVariantList children;
+    QVariantList ratios;
+    for (int i = 0; i < splitter->count(); ++i)
     {
-        return m_currentTerm->getDbusPath();
+        QWidget *w = splitter->widget(i);
+        if (QSplitter *s = qobject_cast<QSplitter*>(w))
+            children << splitterInfo(s);
+        else if (TermWidget *term = qobject_cast<TermWidget*>(w))
+            children << term->layoutInfo();
+        else
+            continue;
+        // not laid out yet when the window has never been shown
+        ratios << (total > 0 ? double(sizes.value(i)) / total : 1.0 / splitter->count());
     }
-    return QDBusObjectPath();
-}
 
-QList<QDBusObjectPath> TermWidgetHolder::getTerminals()
-{
-    QList<QDBusObjectPath> terminals;
-    const auto ws = findChildren<TermWidget*>();
-    for (TermWidget* w : ws)
-    {
-        terminals.push_back(w->getDbusPath());
-    }
-    return terminals;
+    QVariantMap info;
+    info[QStringLiteral("orientation")] = splitter->orientation() == Qt::Horizontal ? QStringLiteral("horizontal")
+                                                                                     : QStringLiteral("vertical");
+    info[QStringLiteral("ratios")] = ratios;
+    info[QStringLiteral("children")] = children;
+    return info;
 }
 
-QDBusObjectPath TermWidgetHolder::getWindow()
+QVariantMap TermWidgetHolder::layoutInfo()
 {
-    return findParent<MainWindow>(this)->getDbusPath();
+    QVariantMap info;
+    info[QStringLiteral("tab")] = getDbusPathString();
+    info[QStringLiteral("materialized")] = m_currentTerm != nullptr;
+    if (m_currentTerm != nullptr)
+        info[QStringLiteral("activeTerminal")] = m_currentTerm->getDbusPathString();
+    if (QSplitter *top = findChild<QSplitter*>(QString(), Qt::FindDirectChildrenOnly))
+        info[QStringLiteral("split")] = splitterInfo(top);
+    return info;
 }
 
 void TermWidgetHolder::closeTab()
@@ -468,5 +545,30 @@ void TermWidgetHolder::setLabel(const QString &label)
     parent->setLabel(idx, label);
 }
 
+#ifdef HAVE_QDBUS
+
+QDBusObjectPath TermWidgetHolder::getActiveTerminal()
+{
+    return currentTerminal()->getDbusPath();
+}
+
+QList<QDBusObjectPath> TermWidgetHolder::getTerminals()
+{
+    // scripts use the terminals of the tabs they create
+    materialize();
+    QList<QDBusObjectPath> terminals;
+    const auto ws = findChildren<TermWidget*>();
+    for (TermWidget* w : ws)
+    {
+        terminals.push_back(w->getDbusPath());
+    }
+    return terminals;
+}
+
+QDBusObjectPath TermWidgetHolder::getWindow()
+{
+    return findParent<MainWindow>(this)->getDbusPath();
+}
+
 #endif
 
@@ -42,11 +42,12 @@ unspecified count of TermWidgets. Basically it should look like a single TermWid
 for TabWidget - with its signals and slots.
 
 Splitting and collapsing of TermWidgets is done here.
+
+The first TermWidget, and with it the shell, is only created when the tab is
+shown or its terminal is asked for, so that tabs opened in bulk and never
+looked at stay cheap. See materialize().
 */
-class TermWidgetHolder : public QWidget
-#ifdef HAVE_QDBUS
-    , public DBusAddressable
-#endif
+class TermWidgetHolder : public QWidget, public DBusAddressable
 {
     Q_OBJECT
 
@@ -62,17 +63,25 @@ class TermWidgetHolder : public QWidget
         void zoomIn(uint step);
         void zoomOut(uint step);
 
+        // creates the terminal of a tab that has not been shown yet
         TermWidget* currentTerminal();
+        void materialize();
+        bool isMaterialized() const { return m_currentTerm != nullptr; }
+        QString currentDirectory();
         TermWidget* split(TermWidget * term, Qt::Orientation orientation, TerminalConfig cfg, const QString &dbus_id = QString(), int newPercent = 50);
 
         bool hasRunningProcess() const;
+        int terminalCount() const { return m_terminalCount; }
+        void setProfile(const QString &name);
+        QString profileName() const;
+        void setLabel(const QString &label);
+        void closeTab();
+        QVariantMap layoutInfo();
 
         #ifdef HAVE_QDBUS
         QDBusObjectPath getActiveTerminal();
         QList<QDBusObjectPath> getTerminals();
         QDBusObjectPath getWindow();
-        void closeTab();
-        void setLabel(const QString &label);
         #endif
 
 
@@ -91,11 +100,21 @@ class TermWidgetHolder : public QWidget
         void renameSession();
         void termTitleChanged(QString title, QString icon) const;
         void termFocusChanged();
+        void terminalAdded(TermWidget *term);
+        // a terminal was added or closed
+        void terminalsChanged();
+
+    protected:
+        void showEvent(QShowEvent *event) override;
 
     private:
         QString m_wdir;
         QString m_shell;
         TermWidget * m_currentTerm;
+        // what the first terminal is created with
+        TerminalConfig m_config;
+        QString m_dbusId;
+        int m_terminalCount;
 
         void split(TermWidget * term, Qt::Orientation orientation);
         TermWidget * newTerm(TerminalConfig &cfg, const QString &dbus_id = QString());
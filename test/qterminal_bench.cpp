@@ -0,0 +1,61 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by LXQt team                                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "qterminal_bench.h"
+
+#include "qterminalutils.h"
+
+#include <QtTest>
+
+void QTerminalBench::initTestCase()
+{
+    // a generated job command line, as launchers pass it with -e
+    QStringList args{QStringLiteral("/usr/bin/env"), QStringLiteral("JOB=build 42")};
+    for (int i = 0; i < 500; ++i)
+        args << QStringLiteral("--define=key%1=value with spaces").arg(i) << QStringLiteral("'quoted'\\path/%1").arg(i);
+    m_longCommand = quote_command(args);
+}
+
+void QTerminalBench::benchParseCommand_data()
+{
+    QTest::addColumn<QString>("command");
+    QTest::newRow("plain") << QStringLiteral("ssh -t user@host tmux attach -t main");
+    QTest::newRow("quoted") << QStringLiteral(R"(sh -c "cd '/tmp/a b' && make -j8 \"CFLAGS=-O2 -g\"")");
+    QTest::newRow("long") << m_longCommand;
+}
+
+void QTerminalBench::benchParseCommand()
+{
+    QFETCH(QString, command);
+    QStringList args;
+    QBENCHMARK {
+        args = parse_command(command);
+    }
+    QVERIFY(!args.isEmpty());
+}
+
+void QTerminalBench::benchQuoteCommand()
+{
+    const QStringList args = parse_command(m_longCommand);
+    QString command;
+    QBENCHMARK {
+        command = quote_command(args);
+    }
+    QCOMPARE(command, m_longCommand);
+}
+
+QTEST_GUILESS_MAIN(QTerminalBench)
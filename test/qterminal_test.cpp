@@ -17,7 +17,11 @@
 
 #include "qterminal_test.h"
 
+#include "historyarchive.h"
+#include "properties.h"
 #include "qterminalutils.h"
+#include "terminalprofile.h"
+#include "terminalselector.h"
 
 #include <QtTest>
 
@@ -44,10 +48,200 @@ void QTerminalTest::testParseCommand()
     /* Uncommon usage */
     // qterminal -e 'fpad -s \"PATH/ha ha\"'
     QCOMPARE(parse_command(QL1S(R"(fpad -s \"PATH/ha ha\")")),
-             QStringList() << QL1S("fpad") << QL1S("-s") << QL1S("\\\"PATH/ha") << QL1S("ha\\\""));
+             QStringList() << QL1S("fpad") << QL1S("-s") << QL1S("\"PATH/ha") << QL1S("ha\""));
     // qterminal -e 'fpad -s "PATH/ha\ ha"'
     QCOMPARE(parse_command(QL1S(R"(fpad -s "PATH/ha\ ha")")),
-             QStringList() << QL1S("fpad") << QL1S("-s") << QL1S("PATH/ha ha"));
+             QStringList() << QL1S("fpad") << QL1S("-s") << QL1S("PATH/ha\\ ha"));
+
+    /* Quoting as in a POSIX shell */
+    QCOMPARE(parse_command(QL1S(R"(a"b c"'d e'f)")), QStringList() << QL1S("ab cd ef"));
+    QCOMPARE(parse_command(QL1S(R"(echo "" '')")), QStringList() << QL1S("echo") << QString() << QString());
+    QCOMPARE(parse_command(QL1S(R"('a\b' "a\b" "\$\`\"\\")")),
+             QStringList() << QL1S("a\\b") << QL1S("a\\b") << QL1S("$`\"\\"));
+    QCOMPARE(parse_command(QL1S("a \\\n b\\")), QStringList() << QL1S("a") << QL1S("b\\"));
+    QCOMPARE(parse_command(QL1S("  \t")), QStringList());
+    // an unclosed quote extends to the end
+    QCOMPARE(parse_command(QL1S(R"(sh -c 'echo hi)")), QStringList() << QL1S("sh") << QL1S("-c") << QL1S("echo hi"));
+}
+
+void QTerminalTest::testQuoteCommand()
+{
+    QCOMPARE(quote_command(QStringList() << QL1S("ls") << QL1S("-l") << QL1S("/tmp")), QL1S("ls -l /tmp"));
+    QCOMPARE(quote_command(QStringList() << QL1S("a b") << QString()), QL1S("'a b' ''"));
+
+    const QStringList args = QStringList() << QL1S("it's") << QL1S(R"("\$x`)") << QL1S("tab\there") << QL1S("*");
+    QCOMPARE(parse_command(quote_command(args)), args);
+}
+
+void QTerminalTest::testFuzzyMatch()
+{
+    // not a subsequence
+    QCOMPARE(fuzzy_match(u"abc", u"acb"), -1);
+    QCOMPARE(fuzzy_match(u"abcd", u"abc"), -1);
+    QCOMPARE(fuzzy_match(u"x", u""), -1);
+
+    // an empty pattern matches anything
+    QCOMPARE(fuzzy_match(u"", u"anything"), 0);
+
+    // subsequences match
+    QVERIFY(fuzzy_match(u"abc", u"a-b-c") >= 0);
+    QVERIFY(fuzzy_match(u"ssh", u"ssh root@host") >= 0);
+
+    // contiguous beats scattered
+    QVERIFY(fuzzy_match(u"log", u"tail log") > fuzzy_match(u"log", u"list of groups"));
+    // word starts beat word middles
+    QVERIFY(fuzzy_match(u"gs", u"git status") > fuzzy_match(u"gs", u"bigsum"));
+    // the tightest window is scored, not the first one found
+    QCOMPARE(fuzzy_match(u"ab", u"a-----ab"), fuzzy_match(u"ab", u"ab"));
+}
+
+void QTerminalTest::testPasteText()
+{
+    QCOMPARE(paste_text(QL1S("a\r\nb\nc"), false), QL1S("a\rb\rc"));
+    QCOMPARE(paste_text(QL1S("ls"), true), QL1S("\x1b[200~ls\x1b[201~"));
+
+    // pasted text must not leave bracketed paste mode and run the rest at the prompt
+    const QString injected = QL1S("harmless\x1b[201~rm -rf ~\n");
+    const QString sent = paste_text(injected, true);
+    QVERIFY(sent.startsWith(QL1S("\x1b[200~")));
+    QVERIFY(sent.endsWith(QL1S("\x1b[201~")));
+    QCOMPARE(sent.count(QLatin1Char('\x1b')), 2);
+    QCOMPARE(sent, QL1S("\x1b[200~harmless[201~rm -rf ~\r\x1b[201~"));
+    // without bracketing nothing is removed
+    QCOMPARE(paste_text(injected, false), QL1S("harmless\x1b[201~rm -rf ~\r"));
+}
+
+void QTerminalTest::testTerminalSelector()
+{
+    QVariantMap vim{
+        {QStringLiteral("label"), QStringLiteral("build")},
+        {QStringLiteral("cwd"), QStringLiteral("/srv/app/src")},
+        {QStringLiteral("foregroundProcess"), QStringLiteral("vim")},
+        {QStringLiteral("shellPid"), 100},
+        {QStringLiteral("foregroundPid"), 200},
+    };
+    QVariantMap shell{
+        {QStringLiteral("label"), QStringLiteral("prod shell")},
+        {QStringLiteral("cwd"), QStringLiteral("/srv/application")},
+        {QStringLiteral("foregroundProcess"), QStringLiteral("bash")},
+        {QStringLiteral("shellPid"), 300},
+        {QStringLiteral("foregroundPid"), 300},
+    };
+
+    auto matches = [](const QString &expression, const QVariantMap &terminal) {
+        return TerminalSelector::parse(expression).matches(terminal);
+    };
+
+    QVERIFY(matches(QStringLiteral("foregroundProcess == vim"), vim));
+    QVERIFY(!matches(QStringLiteral("foregroundProcess == vim"), shell));
+    QVERIFY(matches(QStringLiteral("foregroundProcess != vim"), shell));
+    QVERIFY(matches(QStringLiteral("label =~ 'prod*'"), shell));
+    QVERIFY(!matches(QStringLiteral("label =~ prod"), shell));
+    QVERIFY(matches(QStringLiteral("label == \"prod shell\""), shell));
+
+    // "under" compares whole path components
+    QVERIFY(matches(QStringLiteral("cwd under /srv/app"), vim));
+    QVERIFY(matches(QStringLiteral("cwd under /srv/app/"), vim));
+    QVERIFY(!matches(QStringLiteral("cwd under /srv/app"), shell));
+    QVERIFY(matches(QStringLiteral("cwd under /"), shell));
+
+    QVERIFY(matches(QStringLiteral("idle"), shell));
+    QVERIFY(!matches(QStringLiteral("idle"), vim));
+    QVERIFY(matches(QStringLiteral("busy"), vim));
+    QVERIFY(matches(QStringLiteral("busy"), QVariantMap()));
+
+    QVERIFY(matches(QStringLiteral("busy and cwd under /srv"), vim));
+    QVERIFY(!matches(QStringLiteral("busy and label == prod"), vim));
+
+    // unknown keys compare as empty
+    QVERIFY(matches(QStringLiteral("nosuchkey != x"), vim));
+
+    const QStringList invalid{
+        QString(),
+        QStringLiteral("   "),
+        QStringLiteral("label"),
+        QStringLiteral("label =="),
+        QStringLiteral("label is x"),
+        QStringLiteral("idle busy"),
+        QStringLiteral("idle and"),
+        QStringLiteral("and idle"),
+    };
+    for (const QString &expression : invalid)
+    {
+        QString error;
+        const TerminalSelector selector = TerminalSelector::parse(expression, &error);
+        QVERIFY2(!selector.isValid(), qPrintable(expression));
+        QVERIFY(!error.isEmpty());
+        QVERIFY(!selector.matches(shell));
+    }
+}
+
+void QTerminalTest::testProfileFollowsSettings()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, dir.path());
+    Properties *props = Properties::Instance(QL1S("qterminal-test"));
+    props->loadSettings();
+
+    const QSharedPointer<const TerminalProfile> before = TerminalProfile::get();
+    QCOMPARE(TerminalProfile::get(), before);
+
+    // as the preferences dialog applies a font
+    QFont font = props->font;
+    font.setPointSize(font.pointSize() + 3);
+    props->font = font;
+    props->saveSettings();
+
+    const QSharedPointer<const TerminalProfile> after = TerminalProfile::get();
+    QVERIFY(after != before);
+    QCOMPARE(after->font(), font);
+    QCOMPARE(before->font().pointSize(), font.pointSize() - 3);
+
+    // saving without a change keeps the shared instance
+    props->saveSettings();
+    QCOMPARE(TerminalProfile::get(), after);
+
+    delete props;
+}
+
+void QTerminalTest::testHistoryArchive()
+{
+    HistoryArchive archive;
+    QVERIFY(archive.isValid());
+    QCOMPARE(archive.read(0), QByteArray());
+
+    archive.append("one\ntwo\n");
+    archive.append(QByteArray());
+    // an unterminated last line is completed
+    archive.append("three");
+    QByteArray large;
+    for (int i = 0; i < 100000; ++i)
+        large += "line " + QByteArray::number(i) + '\n';
+    archive.append(large);
+
+    QCOMPARE(archive.chunkCount(), 3);
+    QCOMPARE(archive.lineCount(), qsizetype(100003));
+    QCOMPARE(archive.read(1), QByteArray("one\ntwo\n"));
+    QCOMPARE(archive.read(archive.chunkCount()), "one\ntwo\nthree\n" + large);
+
+    // with a limit, old chunks go as long as the rest still holds the limit
+    HistoryArchive limited;
+    limited.append("1\n2\n", 3);
+    limited.append("3\n4\n", 3);
+    QCOMPARE(limited.lineCount(), qsizetype(4));
+    limited.append("5\n6\n", 3);
+    QCOMPARE(limited.chunkCount(), 3);
+    QCOMPARE(limited.lineCount(), qsizetype(4));
+    qsizetype lines = 0;
+    QCOMPARE(limited.read(limited.chunkCount(), &lines), QByteArray("3\n4\n5\n6\n"));
+    QCOMPARE(lines, qsizetype(4));
+    limited.append("7\n", 3);
+    QCOMPARE(limited.lineCount(), qsizetype(3));
+    QCOMPARE(limited.read(4, &lines), QByteArray("5\n6\n7\n"));
+    // chunks appended after a snapshot are not part of it
+    QCOMPARE(limited.read(3, &lines), QByteArray("5\n6\n"));
+    QCOMPARE(lines, qsizetype(2));
 }
 
 QTEST_MAIN(QTerminalTest)
@@ -27,6 +27,12 @@ class QTerminalTest : public QObject
     // Each private slot is a test function
 private Q_SLOTS:
     void testParseCommand();
+    void testQuoteCommand();
+    void testFuzzyMatch();
+    void testPasteText();
+    void testTerminalSelector();
+    void testProfileFollowsSettings();
+    void testHistoryArchive();
 };
 
 #endif